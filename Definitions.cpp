@@ -31,6 +31,7 @@
 	//uart2_init(UART_BAUD_SELECT(38400,F_CPU));
 	uart3_init(UART_BAUD_SELECT(57600,F_CPU));
 	lcd_init();
+	lcd_fb_init();
 
  }
 
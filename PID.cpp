@@ -37,6 +37,15 @@ void PID::Initialise(void)
 	REGISTER_SET1(PID_TCCRB,PID_CS2);
 	setpoint=1500;	
 	LowSpeed = true;
+#if PID_FIXED_POINT
+	iAccumulator = 0;
+	kiFine = 0;
+	scheduled = false;
+	feedForward = false;
+	ffTerm = 0;
+	trajectory = false;
+	reference = setpoint;
+#endif
 }
 
 
@@ -46,6 +55,185 @@ void PID::Set_Setpoint(int val)
 	//errSum=0;
 }
 
+#if PID_FIXED_POINT
+
+pid_gain_t PID::Saturate(pid_gain_t value, pid_gain_t maxValue)
+{
+	if (value > maxValue)
+		return maxValue;
+	if (value < 0)
+		return 0;
+	return value;
+}
+
+/*
+ * |x| * gain >> 16 rounded toward zero, like the float version's
+ * conversion back to int. The gain is split into its integer and
+ * fraction halves so both products are 16x16 -> 32 multiplies.
+ */
+static inline int32_t Mul_Q16(pid_gain_t gain, int16_t x)
+{
+	uint16_t magnitude = (x < 0) ? (uint16_t)(0 - x) : (uint16_t)x;
+	int32_t product = (int32_t)(int16_t)(gain >> PID_Q) * magnitude
+					+ (int32_t)(((uint32_t)(uint16_t)gain * magnitude) >> PID_Q);
+	return (x < 0) ? -product : product;
+}
+
+static inline int16_t Clamp16(int32_t value)
+{
+	if (value > 32767)
+		return 32767;
+	if (value < -32768)
+		return -32768;
+	return (int16_t)value;
+}
+
+void PID::Set_PID(float KP,float KI, float KD)
+{
+	int32_t fine = (int32_t)floor(KI * (65536.0 * (1 << PID_KI_FINE)) + 0.5);
+	Set_PID_Q(PID_Q16(KP), fine >> PID_KI_FINE, PID_Q16(KD));
+	if (kiQ == fine >> PID_KI_FINE)
+		kiFine = (uint8_t)fine;
+}
+
+void PID::Set_PID_Q(pid_gain_t KP, pid_gain_t KI, pid_gain_t KD)
+{
+	kpQ=Saturate(KP, PID_KP_MAX);
+	kiQ=Saturate(KI, PID_KI_MAX);
+	kiFine = 0;
+	kdQ=Saturate(KD, PID_KD_MAX);	
+	scheduled = false;
+}
+
+
+/*
+ * Gains per setpoint. Only the 1500 row is tuned (the VG_ set); the other
+ * rows are PLACEHOLDERS, a guessed ramp of less kp/ki below 1500 and more
+ * above it, not taken from any pid_sweep run. That is why
+ * PID_GAIN_SCHEDULE is 0 by default. Tune each band with pid_sweep -s
+ * before enabling it.
+ */
+const PidBand pid_schedule[PID_SCHEDULE_BANDS] PROGMEM =
+{
+	{  500, PID_Q16_CONST(0.80), PID_Q16_CONST(0.0090), PID_Q16_CONST(VG_KD) },
+	{ 1000, PID_Q16_CONST(0.95), PID_Q16_CONST(0.0115), PID_Q16_CONST(VG_KD) },
+	{ 1500, PID_Q16_CONST(VG_KP), PID_Q16_CONST(VG_KI), PID_Q16_CONST(VG_KD) },
+	{ 2000, PID_Q16_CONST(1.20), PID_Q16_CONST(0.0150), PID_Q16_CONST(VG_KD) },
+	{ 2500, PID_Q16_CONST(1.35), PID_Q16_CONST(0.0165), PID_Q16_CONST(VG_KD) },
+	{ 3000, PID_Q16_CONST(1.50), PID_Q16_CONST(0.0180), PID_Q16_CONST(VG_KD) },
+};
+
+/* a + (b - a) * f / 256 without a 64 bit product */
+static pid_gain_t Lerp_Q16(pid_gain_t a, pid_gain_t b, uint8_t f)
+{
+	int32_t d = b - a;
+	return a + (d >> 8) * f + (((d & 0xFF) * f) >> 8);
+}
+
+void pid_schedule_lookup(int setpoint, pid_gain_t &kp, pid_gain_t &ki, pid_gain_t &kd)
+{
+	uint8_t i = 0;
+	while (i < PID_SCHEDULE_BANDS - 1 && setpoint >= (int16_t)pgm_read_word(&pid_schedule[i + 1].setpoint))
+		++i;
+
+	const PidBand *lo = &pid_schedule[i];
+	int16_t low = pgm_read_word(&lo->setpoint);
+	kp = pgm_read_dword(&lo->kp);
+	ki = pgm_read_dword(&lo->ki);
+	kd = pgm_read_dword(&lo->kd);
+	if (i == PID_SCHEDULE_BANDS - 1 || setpoint <= low)
+		return;
+
+	/* only on a setpoint change, so the division is affordable */
+	const PidBand *hi = lo + 1;
+	uint16_t span = (int16_t)pgm_read_word(&hi->setpoint) - low;
+	uint8_t f = ((uint32_t)(setpoint - low) << 8) / span;
+	kp = Lerp_Q16(kp, pgm_read_dword(&hi->kp), f);
+	ki = Lerp_Q16(ki, pgm_read_dword(&hi->ki), f);
+	kd = Lerp_Q16(kd, pgm_read_dword(&hi->kd), f);
+}
+
+void PID::Use_Schedule(void)
+{
+	pid_schedule_lookup(setpoint, kpQ, kiQ, kdQ);
+	kiFine = 0;
+	scheduledSetpoint = setpoint;
+	scheduled = true;
+}
+
+void PID::Use_Feed_Forward(bool on)
+{
+	feedForward = on;
+	ffTerm = on ? ff_lookup(reference) : 0;
+	ffReference = reference;
+}
+
+void PID::Use_Trajectory(uint16_t rate, uint16_t accel)
+{
+	trajectory = rate && accel;
+	if (trajectory)
+	{
+		traj_init(ramp, rate, accel, PID_TRAJ_TICK_MS);
+		traj_reset(ramp, reference);
+	}
+}
+
+void PID::Reset_Reference(int value)
+{
+	reference = value;
+	traj_reset(ramp, value);
+}
+
+/*
+ * New gains for a new setpoint. P and D with the new gains would differ
+ * from the old ones even with nothing else changed; the difference, taken
+ * at the old reference, goes into the integrator so the output only moves
+ * by what the setpoint step itself asks for.
+ */
+void PID::Reschedule(int currentRPM, int lastReference)
+{
+	pid_gain_t kp, ki, kd;
+	pid_schedule_lookup(setpoint, kp, ki, kd);
+
+	int16_t before = Clamp16((int32_t)lastReference - currentRPM);
+	int16_t slope = Clamp16((int32_t)currentRPM - lastRPM);
+	int32_t bump = (Mul_Q16(kpQ, before) - Mul_Q16(kp, before))
+				 - (Mul_Q16(kdQ, slope) - Mul_Q16(kd, slope));
+	if (bump > 2 * MAX_OUTPUT)
+		bump = 2 * MAX_OUTPUT;
+	else if (bump < 2 * MIN_OUTPUT)
+		bump = 2 * MIN_OUTPUT;
+
+	iAccumulator += PID_Q16_INT(bump);
+	if (iAccumulator > PID_Q16_INT(MAX_OUTPUT))
+		iAccumulator = PID_Q16_INT(MAX_OUTPUT);
+	else if (iAccumulator < PID_Q16_INT(MIN_OUTPUT))
+		iAccumulator = PID_Q16_INT(MIN_OUTPUT);
+
+	kpQ = kp;
+	kiQ = ki;
+	kiFine = 0;
+	kdQ = kd;
+	scheduledSetpoint = setpoint;
+}
+
+float PID::Get_Kp()
+{
+	return kpQ / 65536.0;
+}
+
+float PID::Get_Ki()
+{
+	return kiQ / 65536.0;
+}
+
+float PID::Get_Kd()
+{
+	return kdQ / 65536.0;
+}
+
+#else
+
 void PID::Set_PID(float KP,float KI, float KD)
 {
 	kp=KP;
@@ -67,11 +255,77 @@ float PID::Get_Kd()
 {
 	return kd;
 }
+
+#endif /* PID_FIXED_POINT */
+
 int PID::Get_Setpoint()
 {
 	return setpoint;
 }
 
+#if PID_FIXED_POINT
+
+int PID::Compute_PID(int currentRPM,bool LowFlag)
+{
+	uint8_t TimeLimit = 0;
+	if(LowFlag)
+		{
+			TimeLimit = 5;
+
+		}
+
+	int previous = reference;
+	reference = trajectory ? traj_step(ramp, setpoint) : setpoint;
+
+	if(timer >= TimeLimit)
+	{
+		if (scheduled && setpoint != scheduledSetpoint)
+			Reschedule(currentRPM, previous);
+		if (feedForward && reference != ffReference)
+		{
+			ffTerm = ff_lookup(reference);
+			ffReference = reference;
+		}
+		
+		error = Clamp16((int32_t)reference - currentRPM);//speed error
+		
+		pTerm = Clamp16(Mul_Q16(kpQ, error));
+		
+		/* ki < 1.0 and |error| <= 32768 keep ki*|error| below 2^31 */
+		uint16_t magnitude = (error < 0) ? (uint16_t)(0 - error) : (uint16_t)error;
+		int32_t step = (int32_t)((uint32_t)(uint16_t)kiQ * magnitude
+							   + (((uint32_t)kiFine * magnitude) >> PID_KI_FINE));
+		if (step > PID_Q16_INT(2 * MAX_OUTPUT))
+			step = PID_Q16_INT(2 * MAX_OUTPUT);
+		/* the table carries the drive while the reference moves; the
+		   lag behind it is no steady error to integrate */
+		if (feedForward && trajectory && traj_moving(ramp))
+			step = 0;
+		iAccumulator += (error < 0) ? -step : step;
+		if (iAccumulator > PID_Q16_INT(MAX_OUTPUT))
+			iAccumulator = PID_Q16_INT(MAX_OUTPUT);
+		else if (iAccumulator < PID_Q16_INT(MIN_OUTPUT))
+			iAccumulator = PID_Q16_INT(MIN_OUTPUT);
+		iTerm = (iAccumulator < 0) ? -(int)((0 - iAccumulator) >> PID_Q) : (int)(iAccumulator >> PID_Q);
+#if !PID_KEEP_ITERM_FRACTION
+		iAccumulator = PID_Q16_INT(iTerm);
+#endif
+		
+		dTerm = Clamp16(Mul_Q16(kdQ, Clamp16((int32_t)currentRPM - lastRPM)));
+		
+		int output = Clamp16((int32_t)pTerm + iTerm - dTerm + ffTerm);
+		limit(output, MIN_OUTPUT, MAX_OUTPUT);
+		
+		lastRPM = currentRPM;
+		lastOutput = output;
+		timer = 0;
+	}
+	return lastOutput;
+	
+}
+
+#else
+
 int PID::Compute_PID(int currentRPM,bool LowFlag)
 {
 	static int output;
@@ -110,6 +364,8 @@ int PID::Compute_PID(int currentRPM,bool LowFlag)
 	
 }
 
+#endif /* PID_FIXED_POINT */
+
 void inline limit (int &value, int minValue,int maxValue)
 {
 	if (value>maxValue)
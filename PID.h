@@ -19,11 +19,187 @@
 
 #define SETPOINTSTEPPING 10
 
+/*
+ * PID_FIXED_POINT selects the integer engine (default). Set it to 0 to get
+ * the original float controller, kept as the reference for benchmarks
+ * and the host comparison.
+ */
+#ifndef PID_FIXED_POINT
+#define PID_FIXED_POINT 1
+#endif
+
 #include "headers.h"
 #include <math.h>
+#include <stdint.h>
+#include <avr/pgmspace.h>
+#include "feedforward.h"
+#include "trajectory.h"
 
 //extern char buff[20];
 
+#if PID_FIXED_POINT
+
+/*
+ * Gains are Q16.16: 1.0 == 65536. Conversion rounds up, which keeps
+ * kp*error and kd*dRPM on the same side of an integer as the float
+ * products did for the tuned gains (1.07f and 23.87f are a hair above
+ * their decimal value).
+ */
+typedef int32_t pid_gain_t;
+
+#define PID_Q				16
+#define PID_Q16(x)			((pid_gain_t)ceil((x) * 65536.0))
+/* whole number to Q16; a multiply, since << of a negative value is undefined */
+#define PID_Q16_INT(x)		((int32_t)(x) * 65536L)
+
+#define PID_KP_STEP			PID_Q16(0.01)
+#define PID_KI_STEP			PID_Q16(0.0001)
+#define PID_KD_STEP			PID_Q16(0.05)
+
+#define PID_KP_MAX			PID_Q16(255.0)
+#define PID_KI_MAX			0xFFFF			/* ki < 1.0 keeps ki*error in 32 bits */
+
+/*
+ * ki's Q16 value is off from the float by up to 1/65536, and the integral
+ * keeps every count that moves it across an integer. Set_PID() stores 8
+ * more bits of ki, so its products stay on the float's side on a
+ * trajectory. Set_PID_Q() and the schedule have Q16 only; they clear them.
+ */
+#define PID_KI_FINE			8
+#define PID_KD_MAX			PID_Q16(255.0)
+
+/*
+ * The float controller truncates iTerm to an int on every update, so any
+ * ki*error below one count is lost; the gains were tuned that way and it
+ * is kept by default. Set this to 1 to carry the fraction in the Q16
+ * accumulator instead.
+ */
+#ifndef PID_KEEP_ITERM_FRACTION
+#define PID_KEEP_ITERM_FRACTION	0
+#endif
+
+/*
+ * Gain scheduling. After Use_Schedule() the gains follow the setpoint
+ * through pid_schedule[] (PID.cpp): linear between the bands, the end
+ * bands beyond them. A new setpoint is picked up at the next update.
+ * The integrator takes over the change in P and D at the error before
+ * the setpoint moved, so swapping gains alone does not step the output.
+ * Set_PID(), Set_PID_Q() and the Inc_/Dcr_ tuning calls go back to
+ * fixed gains. Only the 1500 RPM band is tuned so far, so main() keeps
+ * the fixed gains unless this is set to 1; pid_sweep always builds it.
+ */
+#ifndef PID_GAIN_SCHEDULE
+#define PID_GAIN_SCHEDULE	0
+#endif
+
+/* Q16 constant for static tables; rounds up like PID_Q16 */
+#define PID_Q16_CONST(x)	((pid_gain_t)((x) * 65536.0 + 0.999999))
+
+struct PidBand
+{
+	int16_t    setpoint;
+	pid_gain_t kp, ki, kd;
+};
+
+#define PID_SCHEDULE_BANDS	6
+
+extern const PidBand pid_schedule[PID_SCHEDULE_BANDS] PROGMEM;
+
+void pid_schedule_lookup(int setpoint, pid_gain_t &kp, pid_gain_t &ki, pid_gain_t &kd);
+
+/*
+ * Feed-forward. With Use_Feed_Forward(true) ff_lookup(setpoint)
+ * (feedforward.h) is added to the output, looked up again at the first
+ * update after a setpoint change. The integrator then only carries
+ * what the table is off by. main() turns it on only once points have
+ * been captured on the machine (CALIB_FF), not for the placeholders.
+ */
+#ifndef PID_FEED_FORWARD
+#define PID_FEED_FORWARD	1
+#endif
+
+/*
+ * Setpoint trajectory. After Use_Trajectory() the PID no longer works
+ * on setpoint directly but on a reference that follows it through a
+ * rate and jerk limited S-curve (trajectory.h), advanced on every
+ * Compute_PID() call, updates or not. setpoint stays the commanded
+ * value everyone reads and writes. Reset_Reference() puts the reference
+ * on the motor's speed, at rest, so a spin-up starts from there. With
+ * feed-forward on as well the integrator holds while the reference
+ * moves: the table gives the drive, and the motor's lag behind a ramp
+ * would only wind it up into an overshoot.
+ */
+#ifndef PID_TRAJECTORY
+#define PID_TRAJECTORY		1
+#endif
+#define PID_TRAJ_TICK_MS	4			/* Compute_PID() period, CONTROL_PERIOD */
+#ifndef PID_TRAJ_RATE
+#define PID_TRAJ_RATE		10000		/* RPM/s */
+#endif
+#ifndef PID_TRAJ_ACCEL
+#define PID_TRAJ_ACCEL		50000		/* RPM/s^2 */
+#endif
+
+class PID
+{
+	private:
+	
+	
+	char a;
+	
+	int pTerm, iTerm, dTerm,lastRPM;
+	int error;
+	int32_t iAccumulator;					/* Q16, saturated to the output range */
+	uint8_t kiFine;							/* ki bits below Q16 (PID_KI_FINE) */
+	bool LowSpeed;
+	bool scheduled;
+	int scheduledSetpoint;					/* setpoint the gains were looked up for */
+	bool feedForward;
+	int ffReference;						/* reference ffTerm was looked up for */
+	int ffTerm;
+	bool trajectory;
+	Trajectory ramp;
+	int reference;							/* what the error is taken against */
+	
+	static pid_gain_t Saturate(pid_gain_t value, pid_gain_t maxValue);
+	void Reschedule(int currentRPM, int lastReference);
+
+	public:
+	uint8_t timer;
+	int setpoint,lastOutput;
+	pid_gain_t kpQ,kiQ,kdQ;
+	void Initialise(void);
+	void Inc_KP(void){kpQ = Saturate(kpQ + PID_KP_STEP, PID_KP_MAX); scheduled = false;};
+	void Dcr_KP(void){kpQ = Saturate(kpQ - PID_KP_STEP, PID_KP_MAX); scheduled = false;};
+	void Inc_KI(void){kiQ = Saturate(kiQ + PID_KI_STEP, PID_KI_MAX); scheduled = false;};
+	void Dcr_KI(void){kiQ = Saturate(kiQ - PID_KI_STEP, PID_KI_MAX); scheduled = false;};
+	void Inc_KD(void){kdQ = Saturate(kdQ + PID_KD_STEP, PID_KD_MAX); scheduled = false;};
+	void Dcr_KD(void){kdQ = Saturate(kdQ - PID_KD_STEP, PID_KD_MAX); scheduled = false;};
+	void Inc_Setpoint(void){setpoint += SETPOINTSTEPPING;};
+	void Dcr_Setpoint(void){setpoint -= SETPOINTSTEPPING;};
+	void Set_Setpoint(int val);
+	void Set_PID(float KP,float KI, float KD);
+	void Set_PID_Q(pid_gain_t KP, pid_gain_t KI, pid_gain_t KD);
+	void Use_Schedule(void);
+	bool Is_Scheduled(void) {return scheduled;};
+	void Use_Feed_Forward(bool on);
+	int Get_ffTerm(void)	{return ffTerm;};
+	void Use_Trajectory(uint16_t rate, uint16_t accel);
+	void Reset_Reference(int value);
+	int Get_Reference(void)	{return reference;};
+	float Get_Kp(void);
+	float Get_Ki(void);
+	float Get_Kd(void);
+	
+	int Get_Setpoint(void);
+	int Get_Pterm(void)	{return pTerm;};
+	int Get_Iterm(void)	{return iTerm;};
+	int Get_dTerm(void)	{return dTerm;};
+	int Compute_PID(int input, bool LowFlag);
+};
+
+#else
+
 class PID
 {
 	private:
@@ -62,5 +238,17 @@ class PID
 	int Compute_PID(int input, bool LowFlag);
 };
 
+#endif /* PID_FIXED_POINT */
+
+/* the float reference has no schedule, feed-forward or trajectory */
+#if !PID_FIXED_POINT
+#undef PID_GAIN_SCHEDULE
+#define PID_GAIN_SCHEDULE	0
+#undef PID_FEED_FORWARD
+#define PID_FEED_FORWARD	0
+#undef PID_TRAJECTORY
+#define PID_TRAJECTORY		0
+#endif
+
 void inline limit (int &value, int minValue,int maxValue);
-#endif /*PID_H_*/
\ No newline at end of file
+#endif /*PID_H_*/
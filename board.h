@@ -0,0 +1,159 @@
+/*
+ * board.h
+ *
+ * Created: 10/17/2026 11:02:40 PM
+ *  Author: Bibek Shrestha
+ *
+ * Typed view of the pin and timer map in headers.h (pins.h), and the
+ * compile-time check that no pin or timer is claimed twice. Anything that
+ * moves a motor, encoder, limit switch, UART or the LCD to another pin
+ * or timer must keep BOARD_PINS / BOARD_TIMERS below up to date; a clash
+ * then fails the build here instead of on the bench. The motor PWM
+ * outputs come in through MOTOR_PWM_TIMERS / MOTOR_PWM_PINS (headers.h).
+ */
+
+
+#ifndef BOARD_H_
+#define BOARD_H_
+
+#include "headers.h"
+#include "pins.h"
+#include "scheduler.h"
+
+
+/* RPM inputs: the INTn pin, or the ICPn pin of the timer in capture mode */
+typedef ExtInt<MOTORBACK_INT_NUM>		MotorBackInt;
+typedef Timer16<MOTORBACK_TIMER_NUM>	MotorBackTimer;
+typedef ExtInt<MOTORFRONT_INT_NUM>		MotorFrontInt;
+typedef Timer16<MOTORFRONT_TIMER_NUM>	MotorFrontTimer;
+typedef ExtInt<SIDEMOTOR_INT_NUM>		SideMotorInt;
+typedef Timer16<SIDEMOTOR_TIMER_NUM>	SideMotorTimer;
+
+#if MOTORBACK_CAPTURE
+typedef MotorBackTimer::IcpPin			MotorBackRpmPin;
+#else
+typedef MotorBackInt::Pin				MotorBackRpmPin;
+#endif
+#if MOTORFRONT_CAPTURE
+typedef MotorFrontTimer::IcpPin			MotorFrontRpmPin;
+#else
+typedef MotorFrontInt::Pin				MotorFrontRpmPin;
+#endif
+#if SIDEMOTOR_CAPTURE
+typedef SideMotorTimer::IcpPin			SideMotorRpmPin;
+#else
+typedef SideMotorInt::Pin				SideMotorRpmPin;
+#endif
+
+/* magazine encoders, A on INTn and B sampled or on pin change (4x);
+   4x needs B moved to PK0/PK1 on the board (headers.h) */
+typedef ExtInt<EN_FRONT_INT_NUM>		EnFrontInt;
+typedef ExtInt<EN_BACK_INT_NUM>			EnBackInt;
+typedef EnFrontInt::Pin					EnFrontA;
+typedef EnBackInt::Pin					EnBackA;
+#if EN_FRONT_4X
+typedef PIN_TYPE(EN_FRONT_B4X)			EnFrontB;
+#else
+typedef PIN_TYPE(ENCODERFRONTB)			EnFrontB;
+#endif
+#if EN_BACK_4X
+typedef PIN_TYPE(EN_BACK_B4X)			EnBackB;
+#else
+typedef PIN_TYPE(ENCODERBACKB)			EnBackB;
+#endif
+
+/* limit switches */
+typedef ExtInt<FL_INT_NUM>				FlInt;
+typedef FlInt::Pin						FlLimit;
+typedef PIN_TYPE(DD_MGZ_LIMIT)			MagazineLimit;
+typedef PIN_TYPE(DD_THR_LIMIT)			ThrowLimit;
+
+/* serial ports in use (uart.h) */
+typedef Pin<PortE, 0>					Uart0Rx;
+typedef Pin<PortE, 1>					Uart0Tx;
+typedef Pin<PortD, 2>					Uart1Rx;
+typedef Pin<PortD, 3>					Uart1Tx;
+typedef Pin<PortH, 0>					Uart2Rx;
+typedef Pin<PortH, 1>					Uart2Tx;
+typedef Pin<PortJ, 0>					Uart3Rx;
+typedef Pin<PortJ, 1>					Uart3Tx;
+
+/* character LCD (lcd.h) */
+typedef PIN_TYPE(LCD_EN)				LcdEn;
+typedef PIN_TYPE(LCD_RS)				LcdRs;
+typedef PIN_TYPE(LCD_D7)				LcdD7;
+typedef PIN_TYPE(LCD_D6)				LcdD6;
+typedef PIN_TYPE(LCD_D5)				LcdD5;
+typedef PIN_TYPE(LCD_D4)				LcdD4;
+
+/* scheduler tick (scheduler.h), taken whole: its OCnA-C pins are dead */
+typedef Timer16<SCHED_TIMER_NUM>		SchedTimer;
+typedef SchedTimer::OcaPin				SchedOcA;
+typedef SchedTimer::OcbPin				SchedOcB;
+typedef SchedTimer::OccPin				SchedOcC;
+
+/* LCD flusher pacing (lcd.h), also taken whole */
+typedef Timer8<LCD_FB_TIMER_NUM>		LcdFbTimer;
+typedef LcdFbTimer::OcaPin				LcdFbOcA;
+typedef LcdFbTimer::OcbPin				LcdFbOcB;
+
+
+/* encoder state (A << 1) | B; the back encoder's B is inverted */
+static inline uint8_t en_front_ab(void)
+{
+	return (EnFrontA::read() << 1) | EnFrontB::read();
+}
+
+static inline uint8_t en_back_ab(void)
+{
+	return (EnBackA::read() << 1) | !EnBackB::read();
+}
+
+
+/* claim checks */
+#if defined(USING_UART1)
+#define BOARD_UART1_PINS(X, port)	X(Uart1Rx, port) X(Uart1Tx, port)
+#else
+#define BOARD_UART1_PINS(X, port)
+#endif
+#if defined(USING_UART2)
+#define BOARD_UART2_PINS(X, port)	X(Uart2Rx, port) X(Uart2Tx, port)
+#else
+#define BOARD_UART2_PINS(X, port)
+#endif
+
+#define BOARD_PINS(X, port)																	\
+	X(MotorBackRpmPin, port) X(MotorFrontRpmPin, port) X(SideMotorRpmPin, port)				\
+	X(EnFrontA, port) X(EnFrontB, port) X(EnBackA, port) X(EnBackB, port)					\
+	X(FlLimit, port) X(MagazineLimit, port) X(ThrowLimit, port)								\
+	X(Uart0Rx, port) X(Uart0Tx, port) X(Uart3Rx, port) X(Uart3Tx, port)						\
+	BOARD_UART1_PINS(X, port) BOARD_UART2_PINS(X, port)										\
+	X(LcdEn, port) X(LcdRs, port) X(LcdD7, port) X(LcdD6, port) X(LcdD5, port) X(LcdD4, port)	\
+	X(SchedOcA, port) X(SchedOcB, port) X(SchedOcC, port)									\
+	X(LcdFbOcA, port) X(LcdFbOcB, port)														\
+	MOTOR_PWM_PINS(X, port)
+
+PINS_CHECK_PORT(BOARD_PINS, PortA)
+PINS_CHECK_PORT(BOARD_PINS, PortB)
+PINS_CHECK_PORT(BOARD_PINS, PortC)
+PINS_CHECK_PORT(BOARD_PINS, PortD)
+PINS_CHECK_PORT(BOARD_PINS, PortE)
+PINS_CHECK_PORT(BOARD_PINS, PortF)
+PINS_CHECK_PORT(BOARD_PINS, PortG)
+PINS_CHECK_PORT(BOARD_PINS, PortH)
+PINS_CHECK_PORT(BOARD_PINS, PortJ)
+PINS_CHECK_PORT(BOARD_PINS, PortK)
+PINS_CHECK_PORT(BOARD_PINS, PortL)
+
+#define BOARD_TIMERS(X)																		\
+	X(PID_TIMER_NUM) X(MOTORFRONT_TIMER_NUM) X(LCD_FB_TIMER_NUM)							\
+	X(MOTORBACK_TIMER_NUM) X(SIDEMOTOR_TIMER_NUM) X(SCHED_TIMER_NUM)							\
+	MOTOR_PWM_TIMERS(X)
+
+PINS_CHECK_TIMERS(BOARD_TIMERS)
+
+#if defined(MOTOR_PWM_UNKNOWN) && !defined(HOST_BUILD) && !defined(SIM_BENCH)
+#warning "MOTOR_PWM_TIMERS/MOTOR_PWM_PINS not set (headers.h): motor PWM outputs are not claim checked"
+#endif
+
+#endif /* BOARD_H_ */
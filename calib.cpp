@@ -0,0 +1,154 @@
+/*
+ * calib.cpp
+ *
+ * Created: 10/18/2026 4:36:02 AM
+ *  Author: Bibek Shrestha
+ */
+
+
+#include "calib.h"
+
+#include <avr/eeprom.h>
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <stddef.h>
+#include <string.h>
+#include <util/crc16.h>
+
+typedef char CalibRecordFitsSlot[sizeof(CalibRecord) < CALIB_SLOT_SIZE ? 1 : -1];
+typedef char CalibRingFitsEeprom[CALIB_EE_BASE + CALIB_SLOTS * CALIB_SLOT_SIZE <= E2END + 1 ? 1 : -1];
+
+
+CalibRecord calib;
+
+static uint8_t slot;
+static bool dirty;
+
+/* owned by the EE_READY interrupt while writing */
+static CalibRecord shadow;
+static uint16_t writeBase;
+static volatile uint8_t writePos;
+static volatile bool writing;
+
+
+static uint16_t calib_slot_address(uint8_t index)
+{
+	return CALIB_EE_BASE + (uint16_t)index * CALIB_SLOT_SIZE;
+}
+
+static uint16_t calib_crc(const CalibRecord &record)
+{
+	const uint8_t *p = (const uint8_t *)&record;
+	uint16_t crc = 0xFFFF;
+
+	for (uint8_t i = 0; i < offsetof(CalibRecord, crc); ++i)
+		crc = _crc16_update(crc, p[i]);
+	return crc;
+}
+
+void calib_init(void)
+{
+	uint16_t rejected = 0;				/* bit per slot that failed its CRC */
+
+	for (;;)
+	{
+		int8_t newest = -1;
+		uint8_t newestSequence = 0;
+
+		for (uint8_t s = 0; s < CALIB_SLOTS; ++s)
+		{
+			const uint8_t *address = (const uint8_t *)(uintptr_t)calib_slot_address(s);
+
+			if ((rejected & (1U << s)) || eeprom_read_byte(address) != CALIB_VERSION)
+				continue;
+
+			uint8_t sequence = eeprom_read_byte(address + 1);
+			if (newest < 0 || (int8_t)(sequence - newestSequence) > 0)
+			{
+				newest = s;
+				newestSequence = sequence;
+			}
+		}
+		if (newest < 0)
+			break;
+
+		eeprom_read_block(&calib, (const void *)(uintptr_t)calib_slot_address(newest), sizeof(CalibRecord));
+		if (calib.crc == calib_crc(calib))
+		{
+			slot = newest;
+			dirty = false;
+			return;
+		}
+		rejected |= 1U << newest;
+	}
+
+	/* nothing saved yet: the first save goes to slot 0 */
+	memset(&calib, 0, sizeof(calib));
+	calib.version = CALIB_VERSION;
+	slot = CALIB_SLOTS - 1;
+	dirty = false;
+}
+
+void calib_save(void)
+{
+	dirty = true;
+}
+
+void calib_step(void)
+{
+	if (!dirty || writing)
+		return;
+
+	/* the interrupt is off, so the shadow is ours */
+	slot = (slot + 1) % CALIB_SLOTS;
+	calib.version = CALIB_VERSION;
+	++calib.sequence;
+	calib.crc = calib_crc(calib);
+	memcpy(&shadow, &calib, sizeof(shadow));		/* padding too, as the CRC saw it */
+	dirty = false;
+
+	writeBase = calib_slot_address(slot);
+	writePos = 0;
+	writing = true;
+	EECR |= _BV(EERIE);
+}
+
+bool calib_busy(void)
+{
+	return dirty || writing;
+}
+
+uint8_t calib_slot(void)
+{
+	return slot;
+}
+
+
+/*
+ * Fires as long as no EEPROM write is in progress, so a byte that
+ * already matches costs one short pass and the next comes straight
+ * after, with the other interrupts served in between.
+ */
+ISR(EE_READY_vect)
+{
+	uint8_t pos = writePos;
+
+	if (pos == sizeof(CalibRecord))
+	{
+		EECR &= ~_BV(EERIE);
+		writing = false;
+		return;
+	}
+	writePos = pos + 1;
+
+	uint16_t address = writeBase + pos;
+	uint8_t value = ((const uint8_t *)&shadow)[pos];
+
+	if (eeprom_read_byte((const uint8_t *)(uintptr_t)address) != value)
+	{
+		EEAR = address;
+		EEDR = value;
+		EECR |= _BV(EEMPE);			/* EEPE within four cycles of this */
+		EECR |= _BV(EEPE);
+	}
+}
@@ -0,0 +1,73 @@
+/*
+ * calib.h
+ *
+ * Created: 10/18/2026 4:36:02 AM
+ *  Author: Bibek Shrestha
+ *
+ * Calibration kept over resets: hand tuned PID gains, captured
+ * feed-forward points and throw profile overrides, as one versioned
+ * record with a CRC-16 in RAM (calib) and in EEPROM.
+ *
+ * The EEPROM holds a ring of CALIB_SLOTS record slots. Every save goes
+ * to the slot after the last one with the sequence number one up, so
+ * wear is spread over the whole ring and a save cut short by a reset
+ * only costs that slot: its CRC fails and the one before is used.
+ * calib_init() reads the version and sequence bytes of each slot, then
+ * the newest valid record in one block.
+ *
+ * Saving never waits on the EEPROM. calib_save() marks the record dirty;
+ * calib_step(), from a background task, copies it and hands the copy to
+ * the EE_READY interrupt, which programs one byte per interrupt (about
+ * 3.4 ms each, bytes that already match are skipped). Changes made while
+ * a save runs go out with the next one.
+ */
+
+
+#ifndef CALIB_H_
+#define CALIB_H_
+
+#include <stdint.h>
+
+#include "feedforward.h"
+#include "profile.h"
+
+#define CALIB_VERSION		2			/* 2: profiles lost side RPM and arm delay */
+
+#define CALIB_EE_BASE		0x000
+#define CALIB_SLOT_SIZE		256
+#define CALIB_SLOTS			16				/* the whole 4 KB */
+
+/* CalibRecord.present */
+#define CALIB_GAINS			0x01
+#define CALIB_FF			0x02
+
+struct CalibRecord
+{
+	uint8_t  version;					/* CALIB_VERSION; 0xFF in an erased slot */
+	uint8_t  sequence;					/* one up per save, wrapping */
+	uint8_t  present;					/* CALIB_* of the parts below in use */
+	uint8_t  profileMask;				/* bit per overridden profile */
+	int32_t  kp, ki, kd;				/* Q16.16, as PID::Set_PID_Q() takes them */
+	FfPoint  ff[FF_POINTS];
+	ThrowProfile profiles[PROFILE_COUNT];
+	uint16_t crc;						/* CRC-16 of everything before it */
+};
+
+extern CalibRecord calib;
+
+/* before sei(): loads the newest valid record, or an empty one */
+void calib_init(void);
+
+/* queues the current calib for writing; returns at once */
+void calib_save(void);
+
+/* from a background task: starts a queued save once the last is written */
+void calib_step(void);
+
+/* a save queued or being written */
+bool calib_busy(void);
+
+/* ring slot of the record loaded or last written */
+uint8_t calib_slot(void);
+
+#endif /* CALIB_H_ */
@@ -0,0 +1,44 @@
+/*
+ * capture.cpp
+ *
+ * Created: 10/17/2026 7:26:51 PM
+ *  Author: Bibek Shrestha
+ */ 
+
+
+#include "declarations.h"
+#include "capture.h"
+#include "board.h"
+
+
+/*
+ * Call after the motors' Initialise(), which set the timer prescalers and
+ * enable the INTn edges: switches the selected motors over to capture on
+ * the rising edge with the noise canceller on.
+ */
+void capture_init(void)
+{
+#if MOTORBACK_CAPTURE
+	MotorBackInt::disable();
+	MotorBackTimer::IcpPin::input();
+	MotorBackTimer::tccrb() |= _BV(MotorBackTimer::Ices) | _BV(MotorBackTimer::Icnc);
+	MotorBackTimer::tifr() = _BV(MotorBackTimer::Icf);
+	MotorBackTimer::timsk() |= _BV(MotorBackTimer::Icie);
+#endif
+
+#if MOTORFRONT_CAPTURE
+	MotorFrontInt::disable();
+	MotorFrontTimer::IcpPin::input();
+	MotorFrontTimer::tccrb() |= _BV(MotorFrontTimer::Ices) | _BV(MotorFrontTimer::Icnc);
+	MotorFrontTimer::tifr() = _BV(MotorFrontTimer::Icf);
+	MotorFrontTimer::timsk() |= _BV(MotorFrontTimer::Icie);
+#endif
+
+#if SIDEMOTOR_CAPTURE
+	SideMotorInt::disable();
+	SideMotorTimer::IcpPin::input();
+	SideMotorTimer::tccrb() |= _BV(SideMotorTimer::Ices) | _BV(SideMotorTimer::Icnc);
+	SideMotorTimer::tifr() = _BV(SideMotorTimer::Icf);
+	SideMotorTimer::timsk() |= _BV(SideMotorTimer::Icie);
+#endif
+}
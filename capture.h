@@ -0,0 +1,87 @@
+/*
+ * capture.h
+ *
+ * Created: 10/17/2026 7:26:51 PM
+ *  Author: Bibek Shrestha
+ *
+ * RPM period from the 16 bit timers' input capture units. The edge is
+ * timestamped in ICRn by hardware, so ISR entry latency no longer shows
+ * up in the count and the timer is never written (the TCNTn = 0 of the
+ * INTn path loses the counts between the read and the write). The timer
+ * runs free; overflows between two edges extend the period past 16 bits.
+ *
+ * Selected per motor with MOTORxxx_CAPTURE in headers.h.
+ */ 
+
+
+#ifndef CAPTURE_H_
+#define CAPTURE_H_
+
+#include <stdint.h>
+
+/* a motor with no edge for this many overflows is stopped */
+#define CAPTURE_STALL_OVERFLOWS		2
+
+struct CaptureChannel
+{
+	uint16_t last;				/* ICRn at the previous edge */
+	uint8_t  overflows;			/* since the previous edge, saturating */
+	bool     primed;			/* last is valid */
+	volatile uint32_t period;	/* counts between the last two edges, 0 if unknown */
+};
+
+/*
+ * From TIMERn_CAPT_vect. wrapped tells that TOVn was already pending with
+ * a small ICRn, i.e. the timer overflowed before the edge but its ISR has
+ * not run yet; the caller clears TOVn and the overflow is counted here.
+ * Returns the period, 0 for the first edge after a stall.
+ */
+static inline uint32_t capture_edge(CaptureChannel &ch, uint16_t icr, bool wrapped)
+{
+	uint32_t period = 0;
+
+	if (ch.primed)
+		period = ((uint32_t)(ch.overflows + wrapped) << 16) + icr - ch.last;
+
+	ch.last = icr;
+	ch.overflows = 0;
+	ch.primed = true;
+	ch.period = period;
+	return period;
+}
+
+/* From TIMERn_OVF_vect. Returns true once the motor counts as stopped. */
+static inline bool capture_overflow(CaptureChannel &ch)
+{
+	if (ch.overflows < 0xFF)
+		++ch.overflows;
+	if (ch.overflows < CAPTURE_STALL_OVERFLOWS)
+		return false;
+	ch.primed = false;
+	ch.period = 0;
+	return true;
+}
+
+/* Period in the 16 bit unit of the INTn path's Count */
+static inline uint16_t capture_count(uint32_t period)
+{
+	return period > 0xFFFF ? 0xFFFF : (uint16_t)period;
+}
+
+/*
+ * Period to RPM. countsPerMinute is 60 * F_CPU / prescaler / pulses per
+ * revolution; see CAPTURE_COUNTS_PER_MINUTE.
+ */
+#define CAPTURE_COUNTS_PER_MINUTE(prescaler, pulses)	(60UL * F_CPU / (prescaler) / (pulses))
+
+static inline uint16_t capture_rpm(uint32_t period, uint32_t countsPerMinute)
+{
+	if (!period)
+		return 0;
+	uint32_t rpm = (countsPerMinute + period / 2) / period;
+	return rpm > 0xFFFF ? 0xFFFF : (uint16_t)rpm;
+}
+
+void capture_init(void);
+
+#endif /* CAPTURE_H_ */
@@ -0,0 +1,249 @@
+/*
+ * command.cpp
+ *
+ * Created: 10/18/2026 5:20:44 AM
+ *  Author: Bibek Shrestha
+ */
+
+
+#include <util/atomic.h>
+
+#include "command.h"
+#include "frame.h"
+#include "profile.h"
+#include "uart.h"
+
+
+/* decoded bytes of the frame being received; owned by USART3_RX_vect */
+static uint8_t rxBuf[CMD_PAYLOAD_MAX + 1];
+static uint8_t rxLen;
+static uint8_t rxLeft;					/* COBS: bytes until the next code byte */
+static bool    rxZero;					/* COBS: a zero goes before the next block */
+static bool    rxInFrame;
+static bool    rxSkip;					/* too long: dropped up to the next 0x00 */
+static uint16_t rxLast;					/* ms, the last byte */
+static bool    framed;
+
+static uint8_t lastSequence;
+static bool    haveLast;
+
+/* handed over by rxReady: the ISR writes it only while clear */
+static CmdFrame pending;
+static volatile bool rxReady;
+
+static CmdStats stats;
+
+
+static uint8_t cmd_parse(const uint8_t *p, uint8_t len, CmdFrame &frame, bool &stop)
+{
+	frame.sequence = p[0];
+	frame.count = 0;
+	stop = false;
+
+	for (uint8_t i = 1; i < len; )
+	{
+		CmdItem &item = frame.items[frame.count++];
+
+		item.type = p[i];
+		item.value = 0;
+		switch (item.type)
+		{
+		case CMD_ITEM_BITS:
+		case CMD_ITEM_PROFILE:
+			if (i + 2 > len)
+				return CMD_ERR_ITEM;
+			item.arg = p[i + 1];
+			i += 2;
+			break;
+		case CMD_ITEM_SETPOINT:
+			if (i + 4 > len)
+				return CMD_ERR_ITEM;
+			item.arg = p[i + 1];
+			item.value = (int16_t)(p[i + 2] | (p[i + 3] << 8));
+			i += 4;
+			break;
+		default:
+			return CMD_ERR_ITEM;
+		}
+
+		if (item.type == CMD_ITEM_BITS)
+		{
+			if (!(item.arg & _BV(VALIDITY_BIT)))
+				return CMD_ERR_VALUE;
+			if (item.arg & _BV(STOP_PLATFORM_MOTOR_BIT))
+				stop = true;
+		}
+		else if (item.type == CMD_ITEM_SETPOINT)
+		{
+			if (item.arg > CMD_MOTOR_FRONT || item.value < 0 || item.value > CMD_SETPOINT_MAX)
+				return CMD_ERR_VALUE;
+		}
+		else if (item.arg >= PROFILE_COUNT)
+		{
+			return CMD_ERR_VALUE;
+		}
+	}
+	return CMD_OK;
+}
+
+static void cmd_open(void)
+{
+	rxInFrame = true;
+	rxSkip = false;
+	rxLen = rxLeft = 0;
+	rxZero = false;
+}
+
+/* the closing 0x00 */
+static uint8_t cmd_close(void)
+{
+	if (rxLeft || rxLen < 2)
+	{
+		++stats.badFrame;
+		return CMD_RX_FRAME;
+	}
+	if (crc8(rxBuf, rxLen))				/* over the CRC too: 0 when it matches */
+	{
+		++stats.badCrc;
+		return CMD_RX_FRAME;
+	}
+	framed = true;
+
+	/* parsed in place when free, else only for a stop */
+	CmdFrame spare;
+	CmdFrame &frame = rxReady ? spare : pending;
+	bool stop;
+
+	frame.status = cmd_parse(rxBuf, rxLen - 1, frame, stop);
+	frame.duplicate = haveLast && frame.sequence == lastSequence;
+	if (rxReady)
+	{
+		++stats.busy;
+	}
+	else
+	{
+		if (frame.status == CMD_OK)
+		{
+			lastSequence = frame.sequence;
+			haveLast = true;
+		}
+		rxReady = true;
+	}
+	return stop ? CMD_RX_STOP : CMD_RX_FRAME;
+}
+
+uint8_t cmd_rx(uint8_t c, uint16_t now)
+{
+	bool idle = (uint16_t)(now - rxLast) >= CMD_IDLE_MS;
+	bool started = rxLen || rxLeft || rxZero;
+
+	rxLast = now;
+	if (rxInFrame && idle && c)
+	{
+		/* the link went quiet: whatever was open is given up */
+		if (started && !rxSkip)
+			++stats.badFrame;
+		rxInFrame = false;
+	}
+
+	if (!rxInFrame)
+	{
+		if (c)
+			return CMD_RX_ASCII;
+		cmd_open();
+		return CMD_RX_FRAME;
+	}
+
+	if (!c)
+	{
+		/* the end of this frame is the start of the next */
+		uint8_t r = CMD_RX_FRAME;
+		if (started && !rxSkip)
+			r = cmd_close();
+		cmd_open();
+		return r;
+	}
+	if (rxSkip)
+		return CMD_RX_FRAME;
+
+	if (rxLeft)
+	{
+		--rxLeft;
+	}
+	else
+	{
+		/* code byte: the zero the last one stood for, then c - 1 data bytes */
+		bool zero = rxZero;
+		rxLeft = c - 1;
+		rxZero = c != 0xFF;
+		if (!zero)
+			return CMD_RX_FRAME;
+		c = 0;
+	}
+
+	if (rxLen == sizeof(rxBuf))
+	{
+		++stats.badFrame;
+		rxSkip = true;
+		return CMD_RX_FRAME;
+	}
+	rxBuf[rxLen++] = c;
+	return CMD_RX_FRAME;
+}
+
+bool cmd_take(CmdFrame &frame)
+{
+	if (!rxReady)
+		return false;
+	frame = pending;
+	rxReady = false;
+	++stats.frames;
+	return true;
+}
+
+bool cmd_framed(void)
+{
+	return framed;
+}
+
+bool cmd_wants_data(const CmdFrame &frame)
+{
+	if (frame.status != CMD_OK)
+		return false;
+	for (uint8_t i = 0; i < frame.count; ++i)
+		if (frame.items[i].type == CMD_ITEM_BITS && (frame.items[i].arg & _BV(DATA_RQ_BIT)))
+			return true;
+	return false;
+}
+
+uint8_t cmd_encode_ack(const CmdFrame &frame, const uint8_t *data, uint8_t *out)
+{
+	uint8_t record[2 + CMD_ACK_DATA_SIZE + 1];
+	uint8_t len = 2;
+
+	record[0] = frame.sequence;
+	record[1] = frame.status;
+	if (data)
+	{
+		for (uint8_t i = 0; i < CMD_ACK_DATA_SIZE; ++i)
+			record[len++] = data[i];
+	}
+	out[0] = 0x00;
+	return 1 + frame_seal(record, len, out + 1);
+}
+
+uint8_t cmd_ack(const CmdFrame &frame, const uint8_t *data)
+{
+	uint8_t out[CMD_ACK_FRAME_SIZE];
+	uint8_t len = cmd_encode_ack(frame, data, out);
+
+	return uart3_try_putbuf(out, len);
+}
+
+void cmd_get_stats(CmdStats &s)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		s = stats;
+	}
+}
@@ -0,0 +1,128 @@
+/*
+ * command.h
+ *
+ * Created: 10/18/2026 5:20:44 AM
+ *  Author: Bibek Shrestha
+ *
+ * Binary commands on uart3 (the Bluetooth link), alongside the one byte
+ * ASCII commands. A frame is
+ *
+ *   0x00, COBS(payload, CRC-8), 0x00				(frame.h)
+ *
+ * the leading 0x00 telling it apart from ASCII bytes; further 0x00
+ * between frames are ignored. The payload is a sequence number chosen
+ * by the remote (the next one for every new frame), then as many items
+ * as fit in CMD_PAYLOAD_MAX bytes:
+ *
+ *   CMD_ITEM_BITS      tag, bits       command byte as laid out in
+ *                                      communication.h, VALIDITY_BIT set
+ *   CMD_ITEM_SETPOINT  tag, motor,     absolute setpoint of CMD_MOTOR_x,
+ *                      lo, hi          0..CMD_SETPOINT_MAX RPM
+ *   CMD_ITEM_PROFILE   tag, index      throw profile (profile.h)
+ *
+ * so a start, both setpoints and a profile go over in one frame. Every
+ * frame with a good CRC is answered on uart3, framed the same way:
+ *
+ *   byte  0      sequence number of the frame
+ *   byte  1      CMD_OK, or the CMD_ERR_x that rejected it
+ *   with DATA_RQ_BIT set in an accepted frame, also
+ *   byte  2      1 while running
+ *   bytes 3-6    back RPM, front RPM, little endian
+ *
+ * A frame is checked whole before any of it is applied, so one bad item
+ * rejects all of it. A frame with the sequence number of the last one
+ * accepted is answered again but not applied twice, so the remote can
+ * resend when an answer is lost. Frames that fail the CRC or the COBS
+ * decoding get no answer.
+ *
+ * cmd_rx() takes every uart3 byte in USART3_RX_vect and parses a frame
+ * as soon as its closing 0x00 arrives; the frame then waits for
+ * cmd_take() in the main loop. A frame that completes while the last
+ * one still waits is dropped (the remote waits for the answer), except
+ * that a stop in it still takes effect.
+ *
+ * A 0x00 ends one frame and starts the next, so a delimiter lost on the
+ * link costs the frame before it, and the next frame's body is never
+ * read as ASCII commands. The link only goes back to ASCII when no byte
+ * has come for CMD_IDLE_MS. Once a good frame has been seen, the ASCII
+ * bytes that start the machine or change settings are ignored (see
+ * cmd_framed()).
+ */
+
+
+#ifndef COMMAND_H_
+#define COMMAND_H_
+
+#include <stdint.h>
+
+#include "communication.h"
+
+#define CMD_PAYLOAD_MAX		24				/* sequence and items */
+#define CMD_IDLE_MS			50				/* quiet link: frame given up, ASCII again */
+#define CMD_ITEMS_MAX		(CMD_PAYLOAD_MAX / 2)
+#define CMD_SETPOINT_MAX	4095			/* telemetry's 12 bit field */
+
+#define CMD_ITEM_BITS		0x01
+#define CMD_ITEM_SETPOINT	0x02
+#define CMD_ITEM_PROFILE	0x03
+
+#define CMD_MOTOR_BACK		0
+#define CMD_MOTOR_FRONT		1
+
+#define CMD_OK				0
+#define CMD_ERR_ITEM		1				/* unknown tag or cut short */
+#define CMD_ERR_VALUE		2				/* argument out of range, no VALIDITY_BIT */
+
+/* cmd_rx() */
+#define CMD_RX_ASCII		0				/* not part of a frame; queue it */
+#define CMD_RX_FRAME		1
+#define CMD_RX_STOP			2				/* closed a frame with STOP_PLATFORM_MOTOR_BIT */
+
+#define CMD_ACK_DATA_SIZE	5
+#define CMD_ACK_FRAME_SIZE	(1 + 2 + CMD_ACK_DATA_SIZE + 3)	/* leading 0x00, CRC, COBS code, 0x00 */
+
+struct CmdItem
+{
+	uint8_t type;						/* CMD_ITEM_x */
+	uint8_t arg;						/* bits, motor or profile index */
+	int16_t value;						/* setpoint */
+};
+
+struct CmdFrame
+{
+	uint8_t sequence;
+	uint8_t status;						/* CMD_OK or CMD_ERR_x */
+	bool    duplicate;					/* answer only */
+	uint8_t count;
+	CmdItem items[CMD_ITEMS_MAX];
+};
+
+struct CmdStats
+{
+	uint16_t frames;					/* answered */
+	uint16_t badCrc;
+	uint16_t badFrame;					/* COBS error or too long */
+	uint16_t busy;						/* dropped, the last one not taken yet */
+};
+
+/* in USART3_RX_vect, every byte, now in ms (sched_ticks()): CMD_RX_x */
+uint8_t cmd_rx(uint8_t c, uint16_t now);
+
+/* a frame with a good CRC has come since reset */
+bool cmd_framed(void);
+
+/* main loop: the frame waiting, if any */
+bool cmd_take(CmdFrame &frame);
+
+/* the answer to frame, with CMD_ACK_DATA_SIZE bytes of data if not 0;
+   returns 0 if the TX ring had no room for it */
+uint8_t cmd_ack(const CmdFrame &frame, const uint8_t *data);
+
+/* fills frame (CMD_ACK_FRAME_SIZE bytes) with the answer; returns its length */
+uint8_t cmd_encode_ack(const CmdFrame &frame, const uint8_t *data, uint8_t *out);
+
+bool cmd_wants_data(const CmdFrame &frame);
+
+void cmd_get_stats(CmdStats &stats);
+
+#endif /* COMMAND_H_ */
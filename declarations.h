@@ -18,7 +18,11 @@
 
 #include "headers.h"
 
+#ifdef HOST_BUILD
+void wdt_init(void);
+#else
 void wdt_init(void) __attribute__((naked)) __attribute__((section(".init3")));
+#endif
 
 int Abs(int);
 void initialise();
@@ -0,0 +1,164 @@
+/*
+ * feedforward.cpp
+ *
+ * Created: 10/18/2026 2:14:40 AM
+ *  Author: Bibek Shrestha
+ */
+
+
+#include "feedforward.h"
+#include "format.h"
+#include "uart.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define FF_LINE_SIZE		28			/* "ff rpm=-32768 ocr=-32768\r\n" */
+
+#define FF_CAPTURE_SHIFT	(FF_CAPTURE_SAMPLES == 128 ? 7 : FF_CAPTURE_SAMPLES == 64 ? 6 : \
+							 FF_CAPTURE_SAMPLES == 32 ? 5 : FF_CAPTURE_SAMPLES == 16 ? 4 : -1)
+
+typedef char FfCaptureSamplesPowerOfTwo[FF_CAPTURE_SHIFT >= 0 ? 1 : -1];
+
+
+/*
+ * Placeholders worked out from the default host motor model
+ * (host/tools/motor_sim.h) until points are captured on the machine.
+ */
+const FfPoint ff_table[FF_POINTS] PROGMEM =
+{
+	{  500,  156 },
+	{ 1000,  299 },
+	{ 1500,  444 },
+	{ 2000,  590 },
+	{ 2500,  739 },
+	{ 3000,  890 },
+	{ 3500, 1043 },
+	{ 4000, 1197 },
+};
+
+/* the table in use, filled from ff_table by ff_init() */
+static FfPoint ff_points[FF_POINTS];
+
+void ff_init(void)
+{
+	ff_restore_defaults();
+}
+
+int16_t ff_lookup(int16_t rpm)
+{
+	int16_t r0 = 0, o0 = 0;
+
+	if (rpm <= 0)
+		return 0;
+	for (uint8_t i = 0; i < FF_POINTS; ++i)
+	{
+		int16_t r1 = ff_points[i].rpm;
+		int16_t o1 = ff_points[i].ocr;
+
+		if (rpm <= r1)
+		{
+			int16_t span = r1 - r0;
+			return o0 + (int16_t)(((int32_t)(o1 - o0) * (rpm - r0) + span / 2) / span);
+		}
+		r0 = r1;
+		o0 = o1;
+	}
+	return o0;
+}
+
+void ff_set_points(const FfPoint *points)
+{
+	memcpy(ff_points, points, sizeof(ff_points));
+}
+
+void ff_get_points(FfPoint *points)
+{
+	memcpy(points, ff_points, sizeof(ff_points));
+}
+
+void ff_restore_defaults(void)
+{
+	memcpy_P(ff_points, ff_table, sizeof(ff_points));
+}
+
+/* nearest in RPM, so it stays between its neighbours */
+static void ff_store(int16_t rpm, int16_t ocr)
+{
+	uint8_t nearest = 0;
+
+	for (uint8_t i = 1; i < FF_POINTS; ++i)
+		if (abs(rpm - ff_points[i].rpm) < abs(rpm - ff_points[nearest].rpm))
+			nearest = i;
+	ff_points[nearest].rpm = rpm;
+	ff_points[nearest].ocr = ocr;
+}
+
+
+enum
+{
+	FF_CAPTURE_IDLE,
+	FF_CAPTURE_WAITING,					/* settling or averaging */
+	FF_CAPTURE_READY
+};
+
+static uint8_t ff_capture_state = FF_CAPTURE_IDLE;
+static uint8_t ff_capture_count;
+static int32_t ff_rpm_sum;
+static int32_t ff_ocr_sum;
+
+void ff_capture_begin(void)
+{
+	ff_capture_count = 0;
+	ff_rpm_sum = 0;
+	ff_ocr_sum = 0;
+	ff_capture_state = FF_CAPTURE_WAITING;
+}
+
+void ff_capture_sample(int16_t rpm, int16_t setpoint, int16_t ocr)
+{
+	if (ff_capture_state != FF_CAPTURE_WAITING)
+		return;
+
+	/* only a run of in-band samples counts */
+	if (setpoint <= 0 || abs(rpm - setpoint) > FF_CAPTURE_BAND)
+	{
+		ff_capture_count = 0;
+		ff_rpm_sum = 0;
+		ff_ocr_sum = 0;
+		return;
+	}
+	ff_rpm_sum += rpm;
+	ff_ocr_sum += ocr;
+	if (++ff_capture_count == FF_CAPTURE_SAMPLES)
+		ff_capture_state = FF_CAPTURE_READY;
+}
+
+uint8_t ff_capture_step(void)
+{
+	if (ff_capture_state != FF_CAPTURE_READY)
+		return 0;
+
+	int16_t rpm = (int16_t)((ff_rpm_sum + FF_CAPTURE_SAMPLES / 2) >> FF_CAPTURE_SHIFT);
+	int16_t ocr = (int16_t)((ff_ocr_sum + FF_CAPTURE_SAMPLES / 2) >> FF_CAPTURE_SHIFT);
+
+	char line[FF_LINE_SIZE];
+	FmtBuffer out(line);
+
+	fmt_str_P(out, PSTR("ff rpm="));
+	fmt_i16(out, rpm);
+	fmt_str_P(out, PSTR(" ocr="));
+	fmt_i16(out, ocr);
+	out.put('\r');
+	out.put('\n');
+
+	/* whole line or nothing, without waiting: with the ring too full the
+	   point stays ready and this slot goes to telemetry as usual */
+	uint8_t len = out.p - line;
+	if (uart0_tx_free() < len)
+		return 0;
+	uart0_try_write((const uint8_t *)line, len);
+	ff_store(rpm, ocr);
+	ff_capture_state = FF_CAPTURE_IDLE;
+	return 1;
+}
@@ -0,0 +1,73 @@
+/*
+ * feedforward.h
+ *
+ * Created: 10/18/2026 2:14:40 AM
+ *  Author: Bibek Shrestha
+ *
+ * Open loop part of the flywheel drive: the Ocr a motor needs to hold an
+ * RPM, from measured points with linear interpolation between them
+ * (from 0 RPM / 0 Ocr up to the first point, the last point's Ocr above
+ * it). The PID adds it to its output (PID::Use_Feed_Forward), so
+ * after a setpoint change the integrator only makes up the table's
+ * error instead of winding up the whole drive.
+ *
+ * Points come from steady runs. ff_capture_begin() ('f' on uart3) waits
+ * until the back motor has stayed within FF_CAPTURE_BAND of its setpoint
+ * for FF_CAPTURE_SAMPLES control periods in a row, and ff_capture_step()
+ * then sends the mean RPM and Ocr of those as one text line on uart0:
+ *
+ *   ff rpm=<rpm> ocr=<ocr>
+ *
+ * and puts it in place of the table point nearest in RPM, which keeps the
+ * table ascending. The table starts as ff_table[] in flash; the caller
+ * keeps captured tables in the calibration record (calib.h).
+ */
+
+
+#ifndef FEEDFORWARD_H_
+#define FEEDFORWARD_H_
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+struct FfPoint
+{
+	int16_t rpm;
+	int16_t ocr;
+};
+
+#define FF_POINTS			8
+
+/* factory points, RPM ascending */
+extern const FfPoint ff_table[FF_POINTS] PROGMEM;
+
+/* 0 for rpm <= 0; one division, so callers look up on a setpoint change */
+int16_t ff_lookup(int16_t rpm);
+
+/* at start-up, before the first lookup: the table in use from ff_table */
+void ff_init(void);
+
+/* the table in use; points RPM ascending */
+void ff_set_points(const FfPoint *points);
+void ff_get_points(FfPoint *points);
+void ff_restore_defaults(void);
+
+#ifndef FF_CAPTURE_SAMPLES
+#define FF_CAPTURE_SAMPLES	64			/* power of two; 256 ms at 4 ms */
+#endif
+#ifndef FF_CAPTURE_BAND
+#define FF_CAPTURE_BAND		20			/* RPM */
+#endif
+
+/* starts over if a capture is already waiting */
+void ff_capture_begin(void);
+
+/* every control period while the motors run */
+void ff_capture_sample(int16_t rpm, int16_t setpoint, int16_t ocr);
+
+/* sends and stores a finished point, never waiting on uart0; returns 1 if
+   it did (and so took the telemetry slot), 0 while the line does not fit
+   in the transmit ring yet */
+uint8_t ff_capture_step(void);
+
+#endif /* FEEDFORWARD_H_ */
@@ -0,0 +1,21 @@
+/*
+ * format.cpp
+ *
+ * Created: 10/17/2026 9:48:10 PM
+ *  Author: Bibek Shrestha
+ */
+
+
+#include "format.h"
+
+
+const uint16_t fmt_pow10_16[FMT_U16_DIGITS - 1] PROGMEM =
+{
+	10000, 1000, 100, 10
+};
+
+const uint32_t fmt_pow10_32[FMT_U32_DIGITS - 1] PROGMEM =
+{
+	1000000000UL, 100000000UL, 10000000UL, 1000000UL, 100000UL,
+	10000UL, 1000UL, 100UL, 10UL
+};
@@ -0,0 +1,140 @@
+/*
+ * format.h
+ *
+ * Created: 10/17/2026 9:48:10 PM
+ *  Author: Bibek Shrestha
+ *
+ * Decimal output without division. Each digit is found by subtracting
+ * its power of ten until the value drops below it, at most nine 16 or
+ * 32 bit subtractions per digit. Digits go out most significant first
+ * straight to the destination, so nothing is built on the stack and
+ * reversed.
+ *
+ * This is not shown to be faster than itoa(). On the host, with its
+ * hardware divide, fmt_i16 is about 4x slower (bench_core). The AVR
+ * comparison (make -C sim run-format) has not been run yet.
+ *
+ * The destination is any object with put(char): a UartPort (uart.h),
+ * the LCD sinks in lcd.cpp, or FmtBuffer for a char array.
+ *
+ * width > 0 right aligns unsigned numbers in that many cells, up to 5
+ * (16 bit) or 10 (32 bit), filling with pad ('0' gives leading zeros);
+ * longer numbers are never cut.
+ */
+
+
+#ifndef FORMAT_H_
+#define FORMAT_H_
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+#define FMT_U16_DIGITS		5
+#define FMT_U32_DIGITS		10
+
+extern const uint16_t fmt_pow10_16[FMT_U16_DIGITS - 1] PROGMEM;		/* 10000 .. 10 */
+extern const uint32_t fmt_pow10_32[FMT_U32_DIGITS - 1] PROGMEM;		/* 10^9 .. 10 */
+
+/* writes into a char array; no terminator unless put('\0') */
+struct FmtBuffer
+{
+	char *p;
+
+	FmtBuffer(char *buffer) : p(buffer) {}
+	void put(char c) { *p++ = c; }
+};
+
+
+template <class Out>
+void fmt_u16(Out &out, uint16_t value, uint8_t width = 0, char pad = ' ')
+{
+	bool lead = true;
+
+	for (uint8_t i = 0; i < FMT_U16_DIGITS - 1; ++i)
+	{
+		uint16_t power = pgm_read_word(&fmt_pow10_16[i]);
+		char digit = '0';
+
+		while (value >= power)
+		{
+			value -= power;
+			++digit;
+		}
+		if (digit != '0' || !lead)
+		{
+			lead = false;
+			out.put(digit);
+		}
+		else if (width >= FMT_U16_DIGITS - i)
+		{
+			out.put(pad);
+		}
+	}
+	out.put('0' + (uint8_t)value);
+}
+
+template <class Out>
+void fmt_i16(Out &out, int16_t value)
+{
+	uint16_t magnitude = value;
+
+	if (value < 0)
+	{
+		out.put('-');
+		magnitude = -magnitude;
+	}
+	fmt_u16(out, magnitude);
+}
+
+template <class Out>
+void fmt_u32(Out &out, uint32_t value, uint8_t width = 0, char pad = ' ')
+{
+	bool lead = true;
+
+	for (uint8_t i = 0; i < FMT_U32_DIGITS - 1; ++i)
+	{
+		uint32_t power = pgm_read_dword(&fmt_pow10_32[i]);
+		char digit = '0';
+
+		while (value >= power)
+		{
+			value -= power;
+			++digit;
+		}
+		if (digit != '0' || !lead)
+		{
+			lead = false;
+			out.put(digit);
+		}
+		else if (width >= FMT_U32_DIGITS - i)
+		{
+			out.put(pad);
+		}
+	}
+	out.put('0' + (uint8_t)value);
+}
+
+template <class Out>
+void fmt_i32(Out &out, int32_t value)
+{
+	uint32_t magnitude = value;
+
+	if (value < 0)
+	{
+		out.put('-');
+		magnitude = -magnitude;
+	}
+	fmt_u32(out, magnitude);
+}
+
+/* a string in flash (PSTR), without its terminator */
+template <class Out>
+void fmt_str_P(Out &out, const char *s)
+{
+	char c;
+
+	while ((c = pgm_read_byte(s++)) != '\0')
+		out.put(c);
+}
+
+#endif /* FORMAT_H_ */
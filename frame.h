@@ -0,0 +1,39 @@
+/*
+ * frame.h
+ *
+ * Created: 10/18/2026 5:20:44 AM
+ *  Author: Bibek Shrestha
+ *
+ * Framing shared by the binary telemetry (telemetry.h) and the command
+ * protocol (command.h): a record, its CRC-8 (poly 0x07, init 0) appended,
+ * COBS encoded and terminated by 0x00.
+ *
+ * The CRC is looked up one byte at a time from a 256 byte table in
+ * flash instead of shifted out bit by bit; the result is that of
+ * avr-libc's _crc8_ccitt_update().
+ */
+
+
+#ifndef FRAME_H_
+#define FRAME_H_
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+extern const uint8_t crc8_table[256] PROGMEM;
+
+static inline uint8_t crc8_update(uint8_t crc, uint8_t data)
+{
+	return pgm_read_byte(&crc8_table[crc ^ data]);
+}
+
+uint8_t crc8(const uint8_t *data, uint8_t len);
+
+/*
+ * Appends the CRC-8 of the len bytes at record (which needs room for
+ * it) and writes the COBS frame, 0x00 included, to frame (len + 3
+ * bytes). Returns the frame length. Records stay below 254 bytes.
+ */
+uint8_t frame_seal(uint8_t *record, uint8_t len, uint8_t *frame);
+
+#endif /* FRAME_H_ */
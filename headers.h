@@ -46,6 +46,47 @@
 #define ENCODERFRONTB	E,3
 #define ENCODERBACKB	H,3
 
+//Quadrature decoding of the magazine encoders, see quadrature.h. Channel A
+//interrupts on both edges and B is sampled: 2 edges per count. With
+//EN_xxx_4X set, B is read from a pin change input instead (PE3 and PH3
+//have no interrupt) and both channels interrupt: 4 edges per count.
+//4x is off by default: it needs B rewired from PE3 to PK0 (front) and
+//from PH3 to PK1 (back) first, or the decoder sees B stuck and the
+//count only rocks back and forth by one edge.
+#ifndef EN_FRONT_4X
+#define EN_FRONT_4X				0
+#endif
+#ifndef EN_BACK_4X
+#define EN_BACK_4X				0
+#endif
+
+#define EN_FRONT_B4X			K,0
+#define EN_FRONT_B4X_PCINT		PCINT16
+#define EN_BACK_B4X				K,1
+#define EN_BACK_B4X_PCINT		PCINT17
+#define EN_B4X_PCMSK			PCMSK2
+#define EN_B4X_PCIE				PCIE2
+#define EN_B4X_PCIF				PCIF2
+#define EN_B4X_PCINT_vect		PCINT2_vect
+
+//Edges per Encoder.Count, and so per step of the full resolution count
+//(quad_position()). The encoder state is read by en_front_ab() and
+//en_back_ab() in board.h.
+#if EN_FRONT_4X
+#define EN_FRONT_EDGES			4
+#else
+#define EN_FRONT_EDGES			2
+#endif
+#if EN_BACK_4X
+#define EN_BACK_EDGES			4
+#else
+#define EN_BACK_EDGES			2
+#endif
+
+//A magazine step target calibrated in Encoder.Count, in edges
+#define EN_FRONT_TARGET(count)	((int32_t)(count) * EN_FRONT_EDGES)
+#define EN_BACK_TARGET(count)	((int32_t)(count) * EN_BACK_EDGES)
+
 #endif  //ENCODER_INTVECT_
 
 
@@ -54,49 +95,27 @@
 #ifndef __MOTOR_INTPIN__
 #define __MOTOR_INTPIN__
 
-#define MOTORFRONT_EICR		EICRA
-#define MOTORFRONT_INT		INT3
-#define MOTORFRONT_INTPIN	D,3
-#define MOTORFRONT_ISC0		ISC30
-#define MOTORFRONT_ISC1		ISC31
-#define MOTORFRONT_INTF		INTF3
+//INT number of each input; registers, bits and pin are ExtInt<n> in
+//pins.h (board.h has the typedefs). An ISR can only be named by its
+//vector macro, so that is spelled out here and must follow the number.
+#define MOTORFRONT_INT_NUM	3
 #define MOTORFRONT_INT_vect INT3_vect
 
 
-#define MOTORBACK_EICR		EICRA
-#define MOTORBACK_INT		INT2	
-#define MOTORBACK_INTPIN	D,2
-#define MOTORBACK_ISC0		ISC20
-#define MOTORBACK_ISC1		ISC21
-#define MOTORBACK_INTF		INTF2
+#define MOTORBACK_INT_NUM	2
 #define MOTORBACK_INT_vect	INT2_vect
 
 
 
-#define SIDEMOTOR_EICR		EICRA
-#define SIDEMOTOR_INT		INT0
-#define SIDEMOTOR_INTPIN	D,0
-#define SIDEMOTOR_ISC0		ISC00
-#define SIDEMOTOR_ISC1		ISC01
-#define SIDEMOTOR_INTF		INTF0
+#define SIDEMOTOR_INT_NUM	0
 #define SIDEMOTOR_INT_vect	INT0_vect
 
 
-#define EN_FRONT_EICR		EICRB		
-#define EN_FRONT_INT		INT5
-#define EN_FRONT_INTPIN		E,5
-#define EN_FRONT_ISC0		ISC50
-#define EN_FRONT_ISC1		ISC51
-#define EN_FRONT_INTF		INTF5
+#define EN_FRONT_INT_NUM	5
 #define EN_FRONT_INT_vect	INT5_vect
 
 
-#define EN_BACK_EICR			EICRB			
-#define EN_BACK_INT				INT4	
-#define EN_BACK_INTPIN			E,4		
-#define EN_BACK_ISC0			ISC40	
-#define EN_BACK_ISC1			ISC41	
-#define EN_BACK_INTF			INTF4	
+#define EN_BACK_INT_NUM			4
 #define EN_BACK_INT_vect		INT4_vect
 
 
@@ -107,14 +126,12 @@
 #ifndef __LIMIT_INTERRUPTS__
 #define __LIMIT_INTERRUPTS__
 								
-#define FL_EICR			EICRA
-#define FL_INT			INT1
-#define FL_INTPIN		D,1
-#define FL_ISC0			ISC10
-#define FL_ISC1			ISC11
-#define FL_INTF			INTF1
+#define FL_INT_NUM		1
 #define FL_INT_vect 	INT1_vect
 
+#define DD_MGZ_LIMIT	F,7
+#define DD_THR_LIMIT	B,2
+
 
 #endif  //__LIMIT_INTERRUPTS__
 
@@ -127,17 +144,18 @@
 #define __TIMER_OVERFLOW_VECTORS__
 
 
-
+//Timer number of each motor; registers are Timer16<n> in pins.h
+#define SIDEMOTOR_TIMER_NUM				4
 #define SIDEMOTOR_TIMER_OVERFLOW_VECT	TIMER4_OVF_vect
-#define SIDEMOTOR_TCNT					TCNT4
 
 
+#define MOTORBACK_TIMER_NUM				3
 #define MOTORBACK_TIMER_OVERFLOW_VECT	TIMER3_OVF_vect
-#define MOTORBACK_TCNT					TCNT3
 
+#define MOTORFRONT_TIMER_NUM			1
 #define MOTORFRONT_TIMER_OVERFLOW_VECT	TIMER1_OVF_vect
-#define MOTORFRONT_TCNT					TCNT1
 
+#define PID_TIMER_NUM					0
 #define PID_TIMER						TIMER0
 #define PID_TIMER_OVERFLOW_vect			TIMER0_OVF_vect
 #define PID_TCNT						TCNT0
@@ -147,14 +165,59 @@
 
 
 
+#ifndef __MOTOR_PWM__
+#define __MOTOR_PWM__
+
+//Timers and output compare pins the motor classes (Motor/, Magazine/)
+//drive their outputs from, for the claim check in board.h. Each timer
+//once, each pin as PIN_ON(port, bit), e.g. for OC5A and OC5B:
+//  #define MOTOR_PWM_TIMERS(X)		X(5)
+//  #define MOTOR_PWM_PINS(X, port)	X(PIN_ON(L, 3), port) X(PIN_ON(L, 4), port)
+//Keep them in step with those classes: the scheduler takes timer 5 and
+//the LCD flusher timer 2 whole, and the RPM timers are cleared on every
+//edge, so none of those can carry a motor PWM.
+//Not filled in: Motor/ and Magazine/ are not in this tree and the Proteus
+//schematic has no PWM nets, so the pins are unknown here. Until someone
+//with those sources fills the lists, board.h warns on a firmware build
+//and the motor outputs are not checked.
+#if !defined(MOTOR_PWM_TIMERS) || !defined(MOTOR_PWM_PINS)
+#define MOTOR_PWM_UNKNOWN		1
+#endif
+#ifndef MOTOR_PWM_TIMERS
+#define MOTOR_PWM_TIMERS(X)
+#endif
+#ifndef MOTOR_PWM_PINS
+#define MOTOR_PWM_PINS(X, port)
+#endif
+
+#endif	// __MOTOR_PWM__
+
+
+
+#ifndef __MOTOR_CAPTURE__
+#define __MOTOR_CAPTURE__
+
+//RPM from the timer input capture unit instead of the INTn edge + TCNT
+//read. 1 selects it for that motor; its RPM signal must then be wired to
+//the ICPn pin of the motor's timer.
+#ifndef MOTORBACK_CAPTURE
+#define MOTORBACK_CAPTURE		0
+#endif
+#ifndef MOTORFRONT_CAPTURE
+#define MOTORFRONT_CAPTURE		0
+#endif
+#ifndef SIDEMOTOR_CAPTURE
+#define SIDEMOTOR_CAPTURE		0
+#endif
+
+#define MOTORBACK_CAPT_vect		TIMER3_CAPT_vect
+#define MOTORFRONT_CAPT_vect	TIMER1_CAPT_vect
+#define SIDEMOTOR_CAPT_vect		TIMER4_CAPT_vect
+
+#endif	// __MOTOR_CAPTURE__
+
 
-#define INPUT2(port,pin) DDR ## port &= ~_BV(pin)
-#define OUTPUT2(port,pin) DDR ## port |= _BV(pin)
-#define CLEAR2(port,pin) PORT ## port &= ~_BV(pin)
-#define SET2(port,pin) PORT ## port |= _BV(pin)
-#define TOGGLE2(port,pin) PORT ## port ^= _BV(pin)
 
-#define READ2(port,pin) ((PIN ## port & _BV(pin))?1:0)
 
 #define REGISTER_SET1( REGISTER, BIT1 ) REGISTER|=_BV( BIT1 )
 #define REGISTER_SET2( REGISTER, BIT1, BIT2 ) REGISTER|=_BV( BIT1 )|_BV( BIT2 )
@@ -167,24 +230,13 @@
 #define REGISTER_CLEAR(REGISTER) REGISTER = 0
 
 
-#define INPUT(x) INPUT2(x)
-#define OUTPUT(x) OUTPUT2(x)
-#define CLEAR(x) CLEAR2(x)
-#define SET(x) SET2(x)
-#define TOGGLE(x) TOGGLE2(x)
-#define READ(x) READ2(x)
-#define PULLUP_ON(x) INPUT2(x); SET2(x)
-#define PULLUP_OFF(x) INPUT2(x); CLEAR2(x)
-
-
-
 #include <avr/io.h>
 #include <avr/interrupt.h>
 
 #include <avr/wdt.h>
 
 #include "uart.h"
-#include "Communication.h"
+#include "communication.h"
 #include "lcd.h"
 
 
@@ -0,0 +1,47 @@
+/*
+ * bench.h
+ *
+ * Created: 10/17/2026 9:40:15 AM
+ *  Author: Bibek Shrestha
+ *
+ * Minimal timing loop for the host benchmarks. Each result is printed as
+ * one "key=value" line so scripts can diff runs without parsing prose.
+ */ 
+
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "host_hal.h"
+
+/* keeps the optimiser from discarding a result */
+template <typename T>
+inline void bench_keep(T const &value)
+{
+	asm volatile("" : : "g"(value) : "memory");
+}
+
+template <typename Fn>
+void bench_run(const char *name, uint32_t iterations, Fn fn)
+{
+	typedef std::chrono::steady_clock clock;
+
+	for (uint32_t i = 0; i < iterations / 10 + 1; ++i)		/* warm up */
+		fn(i);
+
+	host_delay_us = 0;
+	clock::time_point start = clock::now();
+	for (uint32_t i = 0; i < iterations; ++i)
+		fn(i);
+	clock::time_point stop = clock::now();
+
+	double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+	printf("bench=%s iters=%u ns_per_op=%.2f target_delay_us_per_op=%.2f\n",
+		   name, iterations, ns / iterations, host_delay_us / iterations);
+}
+
+#endif /* BENCH_H_ */
@@ -0,0 +1,693 @@
+/*
+ * bench_core.cpp
+ *
+ * Created: 10/17/2026 9:40:15 AM
+ *  Author: Bibek Shrestha
+ *
+ * Host microbenchmarks for the control core: PID update, the uart0 ring
+ * buffer and the LCD/telemetry output that main() does every iteration.
+ * Interrupts are played by calling the ISR functions by hand.
+ */ 
+
+
+#include "bench.h"
+
+#include "declarations.h"
+#include "PID.h"
+#include "pid_float_ref.h"
+#include "telemetry.h"
+#include "scheduler.h"
+#include "quadrature.h"
+#include "latency.h"
+#include "format.h"
+#include "trace.h"
+#include "calib.h"
+#include "frame.h"
+#include "command.h"
+#include "capture.h"
+#include "rpmfilter.h"
+
+#include <algorithm>
+#include <math.h>
+
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+
+HOST_VECTOR(USART0_RX_vect);
+HOST_VECTOR(USART0_UDRE_vect);
+HOST_VECTOR(TIMER2_COMPA_vect);
+HOST_VECTOR(TIMER5_COMPA_vect);
+HOST_VECTOR(EE_READY_vect);
+HOST_VECTOR(USART3_RX_vect);
+
+/* play the UDRE interrupt until the TX ring is empty, return bytes sent */
+static uint16_t uart0_drain(void)
+{
+	uint16_t sent = 0;
+	while (UCSR0B & _BV(UDRIE0))
+	{
+		USART0_UDRE_vect();
+		++sent;
+	}
+	return sent ? sent - 1 : 0;
+}
+
+/* play the LCD flusher until it switches itself off, return ticks taken */
+static uint32_t lcd_fb_drain(void)
+{
+	uint32_t ticks = 0;
+	while (TIMSK2 & _BV(OCIE2A))
+	{
+		TIMER2_COMPA_vect();
+		++ticks;
+	}
+	return ticks;
+}
+
+static void lcd_fb_frame(uint32_t i)
+{
+	lcd_fb_gotoxy(0, 0);
+	lcd_fb_num(1500);
+	lcd_fb_putch(' ');
+	lcd_fb_num(1500 + (int)(i & 0x3F));
+	lcd_fb_gotoxy(0, 1);
+	lcd_fb_num(HOMEPOSITION);
+	lcd_fb_putch(' ');
+	lcd_fb_num(NOTGOINGANYWHERE);
+	lcd_fb_putch(' ');
+	lcd_fb_num(0);
+	lcd_fb_putch(' ');
+	lcd_fb_putch('0');
+	lcd_fb_putch(' ');
+	lcd_fb_putch(67);
+}
+
+/* play EE_READY, each write finishing at once, until the save is out */
+static uint32_t calib_drain(void)
+{
+	uint32_t calls = 0;
+	while (EECR & _BV(EERIE))
+	{
+		EE_READY_vect();
+		host_eeprom_tick();
+		++calls;
+	}
+	return calls;
+}
+
+static volatile bool bench_running;
+
+/* main()'s SafetyCommand() as far as the stop goes */
+static uint8_t bench_stop_filter(uint8_t c)
+{
+	if (c != 's')
+		return 0;
+	bench_running = false;
+	return 1;
+}
+
+static void uart3_inject(uint8_t c)
+{
+	UDR3 = c;
+	USART3_RX_vect();
+}
+
+/* main()'s Uart3Command() without the ASCII side; bench_ms is the clock */
+static uint16_t bench_ms;
+
+static uint8_t bench_cmd_filter(uint8_t c)
+{
+	uint8_t r = cmd_rx(c, bench_ms);
+	if (r == CMD_RX_STOP)
+		bench_running = false;
+	return r != CMD_RX_ASCII;
+}
+
+/* payload as the remote sends it; corrupt flips a bit after sealing,
+   cut leaves off the closing 0x00 */
+static void cmd_inject(const uint8_t *payload, uint8_t len, bool corrupt = false, bool cut = false)
+{
+	uint8_t record[CMD_PAYLOAD_MAX + 1], wire[CMD_PAYLOAD_MAX + 4];
+
+	memcpy(record, payload, len);
+	uint8_t n = frame_seal(record, len, wire);
+	if (corrupt)
+		wire[1] ^= 0x10;
+	uart3_inject(0x00);
+	for (uint8_t i = 0; i < n - cut; ++i)
+		uart3_inject(wire[i]);
+}
+
+static void uart0_inject(uint8_t c)
+{
+	UDR0 = c;
+	USART0_RX_vect();
+}
+
+int main(void)
+{
+	host_reset();
+	initialise();
+
+	static PID Controller;
+	Controller.Initialise();
+	Controller.Set_PID(1.07, 0.0135, 23.87);
+
+	bench_run("pid_compute", 1000000, [&](uint32_t i) {
+		Controller.timer = 10;
+		bench_keep(Controller.Compute_PID(1400 + (int)(i & 0x3F), false));
+	});
+
+	PID_Float *Reference = pid_float_create(1.07, 0.0135, 23.87, 1500);
+	bench_run("pid_compute_float", 1000000, [&](uint32_t i) {
+		bench_keep(pid_float_compute(Reference, 1400 + (int)(i & 0x3F)));
+	});
+	pid_float_destroy(Reference);
+
+	/* a spin-up and spin-down between 0 and 3000 RPM, one tick per call */
+	static Trajectory Ramp;
+	traj_init(Ramp, PID_TRAJ_RATE, PID_TRAJ_ACCEL, PID_TRAJ_TICK_MS);
+	traj_reset(Ramp, 0);
+	bench_run("traj_step", 1000000, [&](uint32_t i) {
+		bench_keep(traj_step(Ramp, (i & 0x200) ? 3000 : 0));
+	});
+
+	bench_run("uart0_putc_drain", 1000000, [](uint32_t i) {
+		uart0_putc((unsigned char)i);
+		bench_keep(uart0_drain());
+	});
+
+	bench_run("uart0_putint", 1000000, [](uint32_t i) {
+		uart0_putint(-1400 + (int)(i & 0x7FF));
+		bench_keep(uart0_drain());
+	});
+
+	bench_run("uart0_rx_getc", 1000000, [](uint32_t i) {
+		uart0_inject((uint8_t)i);
+		bench_keep(uart0_getc());
+	});
+
+	bench_run("lcd_num", 1000000, [](uint32_t i) {
+		lcd_num((int)(i & 0xFFF));
+	});
+
+	/* the display and telemetry half of one main() iteration */
+	bench_run("loop_io", 200000, [](uint32_t i) {
+		int rpm = 1500 + (int)(i & 0x3F);
+
+		lcd_gotoxy(0, 0);
+		lcd_num(1500);
+		lcd_putch(' ');
+		lcd_num(rpm);
+		lcd_gotoxy(0, 1);
+		lcd_num(HOMEPOSITION);
+		lcd_putch(' ');
+		lcd_num(NOTGOINGANYWHERE);
+		lcd_putch(' ');
+		lcd_num(0);
+		lcd_putch(' ');
+		lcd_putch('0');
+		lcd_putch(' ');
+		lcd_putch(67);
+
+		uart0_putc('1');
+		uart0_putc(' ');
+		uart0_putint(rpm);
+		uart0_putc(' ');
+		uart0_putint(1500);
+		uart0_putc(' ');
+		uart0_putint(-230);
+		bench_keep(uart0_drain());
+		uart0_putc(' ');
+		uart0_putint(rpm);
+		uart0_putc(' ');
+		uart0_putint(1500);
+		uart0_putc(' ');
+		uart0_putint(-230);
+		uart0_putc('\n');
+		uart0_putc('\r');
+		bench_keep(uart0_drain());
+	});
+
+	/* per-iteration telemetry: the old ASCII line against one binary frame */
+	uint32_t ascii_bytes = 0, binary_bytes = 0, samples = 100000;
+	bench_run("telemetry_ascii", samples, [&](uint32_t i) {
+		int rpm = 1500 + (int)(i & 0x3F);
+		uart0_putc('1');
+		uart0_putc(' ');
+		uart0_putint(rpm);
+		uart0_putc(' ');
+		uart0_putint(1500);
+		uart0_putc(' ');
+		uart0_putint(-230);
+		ascii_bytes += uart0_drain();	/* the ring holds 31 */
+		uart0_putc(' ');
+		uart0_putint(rpm);
+		uart0_putc(' ');
+		uart0_putint(1500);
+		uart0_putc(' ');
+		uart0_putint(-230);
+		uart0_putc('\n');
+		uart0_putc('\r');
+		ascii_bytes += uart0_drain();
+	});
+	bench_run("telemetry_binary", samples, [&](uint32_t i) {
+		TelemetrySample sample;
+		sample.timestamp     = (uint16_t)i;
+		sample.running       = false;
+		sample.position      = HOMEPOSITION;
+		sample.backRPM       = 1500 + (int)(i & 0x3F);
+		sample.backSetpoint  = 1500;
+		sample.backOcr       = -230;
+		sample.frontRPM      = sample.backRPM;
+		sample.frontSetpoint = 1500;
+		sample.frontOcr      = -230;
+		sample.sideRPM       = 0;
+		sample.sideOcr       = 0;
+		sample.load          = 37;
+		telemetry_send(sample);
+		binary_bytes += uart0_drain();
+	});
+	printf("bench=telemetry bytes_ascii=%.1f bytes_binary=%.1f target_us_ascii=%.0f target_us_binary=%.0f\n",
+		   (double)ascii_bytes / (samples + samples / 10 + 1),
+		   (double)binary_bytes / (samples + samples / 10 + 1),
+		   /* 10 bits per byte at 57600 baud */
+		   10e6 / 57600 * ascii_bytes / (samples + samples / 10 + 1),
+		   10e6 / 57600 * binary_bytes / (samples + samples / 10 + 1));
+
+	/*
+	 * Telemetry faster than the line: a record every 2 ms while 57600 baud
+	 * moves 11.5 bytes per 2 ms. The records that find the ring full are
+	 * dropped instead of stalling the task.
+	 */
+	{
+		TelemetrySample sample = TelemetrySample();
+		uint32_t sent = 0, records = 10000, credit = 0;
+
+		uart0_drain();
+		uart0_clear_tx_dropped();
+		for (uint32_t i = 0; i < records; ++i)
+		{
+			for (credit += 115; credit >= 10 && (UCSR0B & _BV(UDRIE0)); credit -= 10)
+			{
+				USART0_UDRE_vect();
+				++sent;
+			}
+			if (!(UCSR0B & _BV(UDRIE0)))
+				credit = 0;
+			sample.timestamp = (uint16_t)(2 * i);
+			telemetry_send(sample);
+		}
+		printf("bench=telemetry_overload records=%u dropped=%u bytes_per_record_sent=%.1f\n",
+			   (unsigned)records, uart0_tx_dropped(), (double)sent / (records - uart0_tx_dropped()));
+		uart0_drain();
+	}
+
+	/*
+	 * Throw capture: a sample every 4 ms control period, triggered at
+	 * sample 200, then sent from the 10 ms telemetry slot while 57600 baud
+	 * moves 57.6 bytes per slot. Reports how long it takes to get out.
+	 */
+	{
+		uint32_t frames = 0, bytes = 0, slots = 0, credit = 0;
+
+		uart0_drain();
+		uart0_clear_tx_dropped();
+		trace_arm(TRACE_PRETRIGGER);
+		for (uint16_t i = 0; trace_state() != TRACE_READY; ++i)
+		{
+			TraceSample sample = TraceSample();
+			sample.timestamp = 4 * i;
+			sample.backRPM   = (i >= 200 && i < 230) ? 1200 : 1500;
+			if (i == 200)
+				trace_trigger(TRACE_TRIGGER_COMMAND);
+			trace_record(sample);
+		}
+		while (trace_dump_step() || (UCSR0B & _BV(UDRIE0)))
+		{
+			++slots;
+			for (credit += 576; credit >= 10 && (UCSR0B & _BV(UDRIE0)); credit -= 10)
+			{
+				USART0_UDRE_vect();
+				if (UCSR0B & _BV(UDRIE0))
+				{
+					++bytes;
+					frames += (UDR0 == 0);
+				}
+			}
+		}
+		printf("bench=trace_capture samples=%u pretrigger=%u frames=%u bytes=%u dump_ms=%u rearmed=%u dropped=%u\n",
+			   TRACE_DEPTH, TRACE_PRETRIGGER, (unsigned)frames, (unsigned)bytes,
+			   (unsigned)(slots * 10), trace_state() == TRACE_ARMED, uart0_tx_dropped());
+	}
+
+	/* the same display through the framebuffer: the loop only writes RAM */
+	bench_run("loop_lcd_fb", 1000000, [](uint32_t i) {
+		lcd_fb_frame(i);
+	});
+	lcd_fb_drain();
+
+	/* flusher cost when only the RPM digits change between frames */
+	uint32_t ticks = 0, frames = 1000;
+	bench_run("lcd_fb_flush", frames, [&](uint32_t i) {
+		lcd_fb_frame(i * 7);
+		ticks += lcd_fb_drain();
+	});
+	printf("bench=lcd_fb_flush ticks_per_frame=%.1f target_us_per_frame=%.0f\n",
+		   (double)ticks / (frames + frames / 10 + 1),
+		   50.0 * ticks / (frames + frames / 10 + 1));
+
+	/*
+	 * Magazine encoder: 1000 cycles forward then 1000 back, every rising A
+	 * edge bouncing once (A, !A, A). The old handler counts each rising A and
+	 * samples B; the decoders see every edge of their channels.
+	 */
+	{
+		static const uint8_t forward[4] = { 0x0, 0x2, 0x3, 0x1 };	/* (A << 1) | B */
+		long old1x = 0, count2x = 0, count4x = 0, peak1x = 0, peak2x = 0, peak4x = 0;
+		QuadDecoder q2 = { 0, 0, 0, 0 }, q4 = { 0, 0, 0, 0 };
+		uint8_t ab = 0;
+
+		for (int dir = 1; dir >= -1; dir -= 2)
+		{
+			for (int i = 0; i < 4000; ++i)
+			{
+				uint8_t next = forward[(dir > 0 ? i + 1 : 4000 - 1 - i) & 3];
+				bool aRise = (next & 2) && !(ab & 2);
+				uint8_t seq[3] = { next, ab, next };
+				for (int k = 0; k < (aRise ? 3 : 1); ++k)
+				{
+					uint8_t s = seq[k];
+					if (((s ^ ab) & 2) && (s & 2))		/* rising A */
+						old1x += (s & 1) ? -1 : 1;
+					if ((s ^ ab) & 2)
+						count2x += quad_count(q2, quad_step_a(q2, s), 2);
+					count4x += quad_count(q4, quad_step(q4, s), 4);
+					ab = s;
+				}
+			}
+			if (dir > 0)
+			{
+				peak1x = old1x;
+				peak2x = count2x;
+				peak4x = count4x;
+			}
+		}
+		printf("bench=quad_bounce cycles=1000 fwd_1x_old=%ld fwd_2x=%ld fwd_4x=%ld"
+			   " back_1x_old=%ld back_2x=%ld back_4x=%ld errors_2x=%u errors_4x=%u\n",
+			   peak1x, peak2x, peak4x, old1x, count2x, count4x, q2.errors, q4.errors);
+	}
+
+	QuadDecoder qd = { 0, 0, 0, 0 };
+	static volatile long quad_count_out;
+	bench_run("quad_step_4x", 4000000, [&](uint32_t i) {
+		static const uint8_t forward[4] = { 0x0, 0x2, 0x3, 0x1 };
+		quad_count_out += quad_count(qd, quad_step(qd, forward[i & 3]), 4);
+	});
+
+	/* one latency sample, as a marked ISR pays it on top of two timer reads */
+	bench_run("lat_record", 4000000, [](uint32_t i) {
+		lat_record(LAT_UART0_RX, (i * 37) & 0x3FF);
+	});
+	const LatencyStat &ls = lat_stats[LAT_UART0_RX];
+	printf("bench=lat_record n=%u min=%u mean=%lu max=%u hist=%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n",
+		   ls.count, ls.min, (unsigned long)(ls.sum / ls.count), ls.max,
+		   ls.hist[0], ls.hist[1], ls.hist[2], ls.hist[3], ls.hist[4],
+		   ls.hist[5], ls.hist[6], ls.hist[7], ls.hist[8], ls.hist[9]);
+	lat_clear();
+
+	/* format.h against printf over all of int16, plus widths and int32 samples */
+	{
+		char ours[16], ref[16];
+		uint32_t mismatches = 0;
+
+		for (int32_t v = -32768; v <= 32767; ++v)
+		{
+			FmtBuffer out(ours);
+			fmt_i16(out, (int16_t)v);
+			out.put('\0');
+			snprintf(ref, sizeof(ref), "%d", (int)v);
+			mismatches += strcmp(ours, ref) != 0;
+
+			FmtBuffer padded(ours);
+			fmt_u16(padded, (uint16_t)v, 5, '0');
+			padded.put('\0');
+			snprintf(ref, sizeof(ref), "%05u", (unsigned)(uint16_t)v);
+			mismatches += strcmp(ours, ref) != 0;
+
+			int32_t wide = v * 131071L + (v & 0xFF);
+			FmtBuffer out32(ours);
+			fmt_i32(out32, wide);
+			out32.put('\0');
+			snprintf(ref, sizeof(ref), "%ld", (long)wide);
+			mismatches += strcmp(ours, ref) != 0;
+		}
+		FmtBuffer top(ours);
+		fmt_u32(top, 4294967295UL);
+		fmt_u32(top, 123, 10);
+		top.put('\0');
+		mismatches += strcmp(ours, "4294967295       123") != 0;
+		printf("bench=format_check mismatches=%u\n", (unsigned)mismatches);
+	}
+
+	static char fmt_out[16];
+	bench_run("fmt_i16", 4000000, [](uint32_t i) {
+		FmtBuffer out(fmt_out);
+		fmt_i16(out, (int16_t)(i * 37));
+	});
+	bench_run("itoa", 4000000, [](uint32_t i) {
+		itoa((int16_t)(i * 37), fmt_out, 10);
+	});
+
+	/* saves round the ring twice, each reloaded as at boot; then the newest
+	   slot torn, which must fall back to the one before */
+	{
+		uint32_t calls = 0, mismatches = 0;
+		int saves = 2 * CALIB_SLOTS;
+
+		calib_init();
+		for (int n = 0; n < saves; ++n)
+		{
+			calib.kp = n;
+			calib.present |= CALIB_GAINS;
+			calib_save();
+			calib_step();
+			calls += calib_drain();
+
+			uint8_t sequence = calib.sequence, slot = calib_slot();
+			calib_init();
+			mismatches += calib.kp != n || calib.sequence != sequence || calib_slot() != slot;
+		}
+		eeprom_update_byte((uint8_t *)(uintptr_t)(CALIB_EE_BASE + calib_slot() * CALIB_SLOT_SIZE + 5), 0x5A);
+		calib_init();
+		mismatches += calib.kp != saves - 2;
+		printf("bench=calib_check saves=%d ee_ready_per_save=%.1f record_bytes=%u mismatches=%u\n",
+			   saves, (double)calls / saves, (unsigned)sizeof(CalibRecord), (unsigned)mismatches);
+	}
+	bench_run("calib_load", 100000, [](uint32_t) {
+		calib_init();
+		bench_keep(calib.sequence);
+	});
+	bench_run("calib_step", 100000, [](uint32_t) {
+		calib_save();
+		calib_step();
+		bench_keep(calib_drain());
+	});
+
+	/* 's' on uart3 until the motors stop. Through the tasks (main() with
+	   CMD_ISR_SAFETY 0) the byte lands somewhere in a tick, CommandTask
+	   reads it at a later tick and the next ControlTask, which runs first
+	   in every fourth tick, stops; run times of other tasks come on top.
+	   With the filter the stop is done inside USART3_RX_vect. */
+	{
+		const int trials = 4000;
+		double sum = 0, worst = 0;
+
+		uart3_set_rx_filter(0);
+		for (int n = 0; n < trials; ++n)
+		{
+			uint32_t tick = (uint32_t)n;
+			double phase = (((uint32_t)n * 2654435761u) >> 16) / 65536.0;
+			bool running = true;
+
+			uart3_inject('s');
+			for (uint32_t t = tick + 1; ; ++t)
+			{
+				if (t % 4 == 0 && !running)
+				{
+					double ms = t - (tick + phase);
+					sum += ms;
+					if (ms > worst)
+						worst = ms;
+					break;
+				}
+				if (running && uart3_available() && uart3_getc() == 's')
+					running = false;
+			}
+		}
+		printf("bench=stop_latency path=tasks trials=%d mean_ms=%.2f max_ms=%.2f\n", trials, sum / trials, worst);
+
+		uart3_set_rx_filter(bench_stop_filter);
+		bench_run("stop_latency_isr", 1000000, [](uint32_t) {
+			bench_running = true;
+			uart3_inject('s');
+			bench_keep(bench_running);
+		});
+		uart3_set_rx_filter(0);
+		printf("bench=stop_latency path=isr queued=%d\n", uart3_available());
+	}
+
+	/* the CRC-8 table against the bitwise update it replaced */
+	{
+		uint32_t mismatches = 0;
+		for (unsigned crc = 0; crc < 256; ++crc)
+			for (unsigned data = 0; data < 256; ++data)
+				mismatches += crc8_update(crc, data) != _crc8_ccitt_update(crc, data);
+		printf("bench=crc8_check mismatches=%u\n", (unsigned)mismatches);
+	}
+	static uint8_t crc_record[TELEMETRY_PAYLOAD_SIZE];
+	bench_run("crc8_table", 1000000, [](uint32_t i) {
+		crc_record[0] = (uint8_t)i;
+		bench_keep(crc8(crc_record, sizeof(crc_record)));
+	});
+	bench_run("crc8_bitwise", 1000000, [](uint32_t i) {
+		uint8_t crc = 0;
+		crc_record[0] = (uint8_t)i;
+		for (uint8_t n = 0; n < sizeof(crc_record); ++n)
+			crc = _crc8_ccitt_update(crc, crc_record[n]);
+		bench_keep(crc);
+	});
+
+	/* command frames through USART3_RX_vect: parsed, repeated, damaged,
+	   rejected, and ASCII bytes between them still queued */
+	{
+		static const uint8_t go[] = { 0x00, CMD_ITEM_BITS, _BV(START_PLATFORM_MOTOR_BIT) | _BV(DATA_RQ_BIT) | _BV(VALIDITY_BIT),
+									  CMD_ITEM_SETPOINT, CMD_MOTOR_BACK, 0xDC, 0x05, CMD_ITEM_PROFILE, 3 };
+		static const uint8_t stop[] = { 0x01, CMD_ITEM_BITS, _BV(STOP_PLATFORM_MOTOR_BIT) | _BV(VALIDITY_BIT) };
+		static const uint8_t range[] = { 0x02, CMD_ITEM_SETPOINT, CMD_MOTOR_FRONT, 0x00, 0x10 };
+		static const uint8_t cut[] = { 0x03, CMD_ITEM_SETPOINT, CMD_MOTOR_FRONT, 0x00 };
+		CmdFrame frame;
+		CmdStats stats;
+		uint8_t ack[CMD_ACK_FRAME_SIZE];
+		uint32_t mismatches = 0;
+
+		uart3_set_rx_filter(bench_cmd_filter);
+		cmd_inject(go, sizeof(go));
+		bench_ms += CMD_IDLE_MS;
+		uart3_inject('c');
+		mismatches += !cmd_take(frame) || frame.status != CMD_OK || frame.duplicate || frame.count != 3
+					  || frame.items[1].value != 1500 || frame.items[2].arg != 3 || !cmd_wants_data(frame);
+		mismatches += uart3_available() != 1 || uart3_getc() != 'c';
+		mismatches += cmd_encode_ack(frame, go, ack) > CMD_ACK_FRAME_SIZE || cmd_encode_ack(frame, 0, ack) != 6;
+
+		cmd_inject(go, sizeof(go));
+		mismatches += !cmd_take(frame) || !frame.duplicate;
+
+		bench_running = true;
+		cmd_inject(stop, sizeof(stop), true);
+		mismatches += cmd_take(frame) || !bench_running;
+		cmd_inject(stop, sizeof(stop));
+		mismatches += !cmd_take(frame) || frame.status != CMD_OK || bench_running;
+
+		cmd_inject(range, sizeof(range));
+		mismatches += !cmd_take(frame) || frame.status != CMD_ERR_VALUE;
+		cmd_inject(cut, sizeof(cut));
+		mismatches += !cmd_take(frame) || frame.status != CMD_ERR_ITEM;
+
+		/* a second frame before the first is taken: dropped, the stop kept */
+		bench_running = true;
+		cmd_inject(go, sizeof(go));
+		cmd_inject(stop, sizeof(stop));
+		mismatches += !cmd_take(frame) || frame.sequence != go[0] || bench_running || cmd_take(frame);
+
+		/* a frame that lost its closing 0x00, then one with 's' (0x73) and
+		   'g' (0x67) in its body: the next 0x00 closes the first, and the
+		   second still parses, none of it taken as ASCII */
+		static const uint8_t body[] = { 0x04, CMD_ITEM_SETPOINT, CMD_MOTOR_BACK, 0x73, 0x07,
+										CMD_ITEM_SETPOINT, CMD_MOTOR_FRONT, 0x67, 0x06 };
+		cmd_inject(stop, sizeof(stop), false, true);
+		uart3_inject(0x00);				/* the next frame's leading one */
+		mismatches += !cmd_take(frame) || frame.sequence != stop[0];
+		cmd_inject(body, sizeof(body));
+		mismatches += uart3_available() != 0 || !cmd_take(frame) || frame.status != CMD_OK
+					  || frame.items[0].value != 0x0773 || frame.items[1].value != 0x0667;
+
+		/* within CMD_IDLE_MS bytes still belong to frames, after it ASCII */
+		uart3_inject('s');
+		mismatches += uart3_available() != 0;
+		bench_ms += CMD_IDLE_MS;
+		uart3_inject('s');
+		mismatches += uart3_available() != 1 || uart3_getc() != 's' || !cmd_framed();
+
+		cmd_get_stats(stats);
+		printf("bench=cmd_check frames=%u bad_crc=%u bad_frame=%u busy=%u queued=%d mismatches=%u\n",
+			   stats.frames, stats.badCrc, stats.badFrame, stats.busy, uart3_available(), (unsigned)mismatches);
+
+		bench_run("cmd_frame", 100000, [](uint32_t) {
+			static const uint8_t inc[] = { 0x00, CMD_ITEM_BITS, _BV(INCREASE_FIRST_MOTOR_SPEED_BIT) | _BV(VALIDITY_BIT),
+										   CMD_ITEM_SETPOINT, CMD_MOTOR_FRONT, 0xDC, 0x05 };
+			CmdFrame taken;
+			cmd_inject(inc, sizeof(inc));
+			bench_keep(cmd_take(taken));
+		});
+		uart3_set_rx_filter(0);
+	}
+
+	/* RPM filter on a steady 1500 RPM (10000 counts at clk/64, one pulse
+	   per turn) with up to 100 counts of edge jitter: RPM error left, and
+	   the medians against a sort */
+	{
+		const uint32_t countsPerMinute = CAPTURE_COUNTS_PER_MINUTE(64, 1);
+		const int edges = 100000;
+		RpmFilter filter = RpmFilter();
+		uint32_t state = 2463534242u, mismatches = 0;
+		double rawSq = 0, filteredSq = 0;
+
+		for (int n = 0; n < edges; ++n)
+		{
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			uint16_t count = (uint16_t)(10000 - 100 + state % 201);
+			double raw = (double)countsPerMinute / count - 1500;
+			double filtered = (double)countsPerMinute / rpm_filter_step(filter, count) - 1500;
+			rawSq += raw * raw;
+			filteredSq += filtered * filtered;
+
+			uint16_t v[5];
+			for (int k = 0; k < 5; ++k)
+				v[k] = (uint16_t)(state >> (3 * k)) & 0x7;
+			uint16_t m3 = rpm_median3(v[0], v[1], v[2]);
+			uint16_t m5 = rpm_median5(v[0], v[1], v[2], v[3], v[4]);
+			std::sort(v, v + 3);
+			mismatches += m3 != v[1];
+			for (int k = 0; k < 5; ++k)
+				v[k] = (uint16_t)(state >> (3 * k)) & 0x7;
+			std::sort(v, v + 5);
+			mismatches += m5 != v[2];
+		}
+		printf("bench=rpm_filter median=%d window=%d rms_rpm_raw=%.2f rms_rpm_filtered=%.2f mismatches=%u\n",
+			   RPM_FILTER_MEDIAN, RPM_FILTER_WINDOW, sqrt(rawSq / edges), sqrt(filteredSq / edges), (unsigned)mismatches);
+	}
+	static RpmFilter bench_filter;
+	bench_run("rpm_filter_step", 4000000, [](uint32_t i) {
+		bench_keep(rpm_filter_step(bench_filter, (uint16_t)(10000 + (i & 0xFF))));
+	});
+
+	/* dispatcher cost per 1ms tick with main()'s task set and empty bodies */
+	static uint32_t task_runs;
+	sched_init();
+	sched_add([] { ++task_runs; }, 4,   0);
+	sched_add([] { ++task_runs; }, 1,   0);
+	sched_add([] { ++task_runs; }, 10,  1);
+	sched_add([] { ++task_runs; }, 100, 2);
+	bench_run("sched_tick", 1000000, [](uint32_t) {
+		TIMER5_COMPA_vect();
+		while (sched_run())
+			;
+	});
+	printf("bench=sched_tick task_runs_per_tick=%.3f overruns=%u\n",
+		   (double)task_runs / (1000000 + 1000000 / 10 + 1), sched_task(0)->overruns);
+
+	return 0;
+}
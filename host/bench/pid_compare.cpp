@@ -0,0 +1,163 @@
+/*
+ * pid_compare.cpp
+ *
+ * Created: 10/17/2026 1:25:02 PM
+ *  Author: Bibek Shrestha
+ *
+ * Compares the fixed-point PID against the float reference, term by term.
+ *
+ *   terms       one update from a fresh controller over every input in
+ *               range, for the default gains and gains reached through
+ *               Inc_K?/Dcr_K?
+ *   trajectory  both controllers fed the same RPM sequence from a simple
+ *               first order motor driven by the float output
+ *
+ * Outputs are only compared where the float one is inside MAX_OUTPUT, as
+ * the fixed-point engine saturates there and the float one does not.
+ *
+ * Each check prints cases, bit-exact matches and the largest difference.
+ * Build with PID_KEEP_ITERM_FRACTION=1 and the integral is expected to
+ * drift on trajectories, since the float version drops the fraction.
+ */ 
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "PID.h"
+#include "pid_float_ref.h"
+
+#define DEFAULT_KP	1.07
+#define DEFAULT_KI	0.0135
+#define DEFAULT_KD	23.87
+#define SETPOINT	1500
+
+
+struct Tally
+{
+	const char *name;
+	long cases, exact, maxDiff;
+
+	void Add(int fixedValue, int floatValue)
+	{
+		long diff = labs((long)fixedValue - floatValue);
+		++cases;
+		if (!diff)
+			++exact;
+		if (diff > maxDiff)
+			maxDiff = diff;
+	}
+
+	void Print(const char *check) const
+	{
+		printf("compare=%s term=%s cases=%ld exact=%ld exact_pct=%.3f max_abs_diff=%ld\n",
+			   check, name, cases, exact, cases ? 100.0 * exact / cases : 0.0, maxDiff);
+	}
+};
+
+
+static void step_gains(PID &fixed, PID_Float *ref, char which, int direction)
+{
+	pid_float_step_gains(ref, which, direction);
+	switch (which)
+	{
+		case 'p': direction > 0 ? fixed.Inc_KP() : fixed.Dcr_KP(); break;
+		case 'i': direction > 0 ? fixed.Inc_KI() : fixed.Dcr_KI(); break;
+		case 'd': direction > 0 ? fixed.Inc_KD() : fixed.Dcr_KD(); break;
+	}
+}
+
+static void make_pair(PID &fixed, PID_Float *&ref, int walk)
+{
+	fixed = PID();
+	fixed.Initialise();
+	fixed.Set_PID(DEFAULT_KP, DEFAULT_KI, DEFAULT_KD);
+	fixed.Set_Setpoint(SETPOINT);
+	ref = pid_float_create(DEFAULT_KP, DEFAULT_KI, DEFAULT_KD, SETPOINT);
+
+	/* same pseudo random walk through the tuning buttons on both */
+	srand(walk);
+	for (int n = 0; n < walk; ++n)
+		step_gains(fixed, ref, "pid"[rand() % 3], (rand() & 1) ? 1 : -1);
+}
+
+static void compare_terms(int walks)
+{
+	Tally p = { "p", 0, 0, 0 }, i = { "i", 0, 0, 0 }, d = { "d", 0, 0, 0 };
+	Tally out = { "output", 0, 0, 0 };
+
+	for (int walk = 0; walk < walks; ++walk)
+	{
+		for (int rpm = 0; rpm <= 3000; ++rpm)
+		{
+			PID fixed;
+			PID_Float *ref;
+			make_pair(fixed, ref, walk);
+
+			/* first update sets lastRPM, the second sees a bounded step */
+			int last = rpm - (rpm - SETPOINT) / 16;
+			fixed.timer = 10;
+			fixed.Compute_PID(last, false);
+			pid_float_compute(ref, last);
+
+			fixed.timer = 10;
+			int output = fixed.Compute_PID(rpm, false);
+			PidTerms r = pid_float_compute(ref, rpm);
+
+			p.Add(fixed.Get_Pterm(), r.p);
+			i.Add(fixed.Get_Iterm(), r.i);
+			d.Add(fixed.Get_dTerm(), r.d);
+			if (r.output >= -1400 && r.output <= 1400)
+				out.Add(output, r.output);
+
+			pid_float_destroy(ref);
+		}
+	}
+	p.Print("terms");
+	i.Print("terms");
+	d.Print("terms");
+	out.Print("terms");
+}
+
+static void compare_trajectory(long steps)
+{
+	Tally out = { "output", 0, 0, 0 }, i = { "i", 0, 0, 0 };
+	PID fixed;
+	PID_Float *ref;
+	make_pair(fixed, ref, 0);
+
+	double rpm = 0;
+	int output = 0;
+	for (long n = 0; n < steps; ++n)
+	{
+		/* setpoint hops every 2000 updates so transients keep coming */
+		int setpoint = 800 + (int)((n / 2000) % 5) * 400;
+		fixed.Set_Setpoint(setpoint);
+		pid_float_set_setpoint(ref, setpoint);
+
+		int measured = (int)rpm;
+		fixed.timer = 10;
+		int fixedOutput = fixed.Compute_PID(measured, false);
+		PidTerms r = pid_float_compute(ref, measured);
+		if (r.output >= -1400 && r.output <= 1400)
+			out.Add(fixedOutput, r.output);
+		i.Add(fixed.Get_Iterm(), r.i);
+
+		output = r.output;
+		if (output > 1400) output = 1400;
+		if (output < -1400) output = -1400;
+		rpm += (output * 2.5 - rpm) * 0.02;
+	}
+	out.Print("trajectory");
+	i.Print("trajectory");
+	pid_float_destroy(ref);
+}
+
+int main(int argc, char *argv[])
+{
+	int walks = (argc > 1) ? atoi(argv[1]) : 16;
+
+	compare_terms(walks);
+	compare_trajectory(100000);
+	return 0;
+}
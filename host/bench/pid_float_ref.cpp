@@ -0,0 +1,51 @@
+/*
+ * pid_float_ref.cpp
+ *
+ * Created: 10/17/2026 1:25:02 PM
+ *  Author: Bibek Shrestha
+ */ 
+
+
+#include "PID.h"
+#include "pid_float_ref.h"
+
+PID_Float *pid_float_create(float kp, float ki, float kd, int setpoint)
+{
+	PID_Float *pid = new PID_Float();
+	pid->Initialise();
+	pid->Set_PID(kp, ki, kd);
+	pid->Set_Setpoint(setpoint);
+	return pid;
+}
+
+void pid_float_destroy(PID_Float *pid)
+{
+	delete pid;
+}
+
+void pid_float_set_setpoint(PID_Float *pid, int setpoint)
+{
+	pid->Set_Setpoint(setpoint);
+}
+
+void pid_float_step_gains(PID_Float *pid, char which, int direction)
+{
+	switch (which)
+	{
+		case 'p': direction > 0 ? pid->Inc_KP() : pid->Dcr_KP(); break;
+		case 'i': direction > 0 ? pid->Inc_KI() : pid->Dcr_KI(); break;
+		case 'd': direction > 0 ? pid->Inc_KD() : pid->Dcr_KD(); break;
+	}
+}
+
+PidTerms pid_float_compute(PID_Float *pid, int rpm)
+{
+	PidTerms terms;
+
+	pid->timer = 10;
+	terms.output = pid->Compute_PID(rpm, false);
+	terms.p = pid->Get_Pterm();
+	terms.i = pid->Get_Iterm();
+	terms.d = pid->Get_dTerm();
+	return terms;
+}
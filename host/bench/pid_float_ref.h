@@ -0,0 +1,29 @@
+/*
+ * pid_float_ref.h
+ *
+ * Created: 10/17/2026 1:25:02 PM
+ *  Author: Bibek Shrestha
+ *
+ * The original float controller, i.e. PID.cpp built with PID_FIXED_POINT=0
+ * and the class renamed to PID_Float so it links next to the fixed-point
+ * one. Only the host benchmarks and pid_compare use it.
+ */ 
+
+
+#ifndef PID_FLOAT_REF_H_
+#define PID_FLOAT_REF_H_
+
+class PID_Float;
+
+struct PidTerms
+{
+	int p, i, d, output;
+};
+
+PID_Float *pid_float_create(float kp, float ki, float kd, int setpoint);
+void pid_float_destroy(PID_Float *pid);
+void pid_float_set_setpoint(PID_Float *pid, int setpoint);
+void pid_float_step_gains(PID_Float *pid, char which, int direction);
+PidTerms pid_float_compute(PID_Float *pid, int rpm);
+
+#endif /* PID_FLOAT_REF_H_ */
@@ -0,0 +1,44 @@
+/*
+ * avr/eeprom.h (host build)
+ *
+ * Created: 10/18/2026 3:52:27 AM
+ *  Author: Bibek Shrestha
+ *
+ * The 4 KB EEPROM as a plain array, erased (0xFF) by host_reset().
+ * Addresses are EEPROM offsets cast to pointers, as the firmware passes
+ * them; EEMEM variables are not supported.
+ */
+
+
+#ifndef HOST_AVR_EEPROM_H_
+#define HOST_AVR_EEPROM_H_
+
+#include <stddef.h>
+
+#include "../host_hal.h"
+
+extern uint8_t host_eeprom[E2END + 1];
+
+static inline uint8_t eeprom_read_byte(const uint8_t *addr)
+{
+	return host_eeprom[(uintptr_t)addr];
+}
+
+static inline void eeprom_update_byte(uint8_t *addr, uint8_t value)
+{
+	host_eeprom[(uintptr_t)addr] = value;
+}
+
+static inline void eeprom_read_block(void *dst, const void *src, size_t n)
+{
+	memcpy(dst, &host_eeprom[(uintptr_t)src], n);
+}
+
+static inline void eeprom_update_block(const void *src, void *dst, size_t n)
+{
+	memcpy(&host_eeprom[(uintptr_t)dst], src, n);
+}
+
+#define eeprom_busy_wait()	((void)0)
+
+#endif /* HOST_AVR_EEPROM_H_ */
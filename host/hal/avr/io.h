@@ -0,0 +1,14 @@
+/*
+ * avr/io.h (host build)
+ *
+ * Created: 10/17/2026 9:12:40 AM
+ *  Author: Bibek Shrestha
+ */ 
+
+
+#ifndef HOST_AVR_IO_H_
+#define HOST_AVR_IO_H_
+
+#include "../host_hal.h"
+
+#endif /* HOST_AVR_IO_H_ */
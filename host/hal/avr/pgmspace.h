@@ -0,0 +1,25 @@
+/*
+ * avr/pgmspace.h (host build)
+ *
+ * Created: 10/17/2026 9:12:40 AM
+ *  Author: Bibek Shrestha
+ *
+ * Flash and RAM share one address space on the host, so PROGMEM data is
+ * read straight through the pointer.
+ */ 
+
+
+#ifndef HOST_AVR_PGMSPACE_H_
+#define HOST_AVR_PGMSPACE_H_
+
+#include "../host_hal.h"
+
+#define PROGMEM
+#define PSTR(s)					(s)
+#define pgm_read_byte(addr)		(*(const uint8_t  *)(addr))
+#define pgm_read_word(addr)		(*(const uint16_t *)(addr))
+#define pgm_read_dword(addr)	(*(const uint32_t *)(addr))
+#define memcpy_P(dst, src, n)	memcpy((dst), (src), (n))
+#define strlen_P(s)				strlen(s)
+
+#endif /* HOST_AVR_PGMSPACE_H_ */
@@ -0,0 +1,24 @@
+/*
+ * avr/sleep.h (host build)
+ *
+ * Created: 10/17/2026 9:02:18 PM
+ *  Author: Bibek Shrestha
+ *
+ * Nothing wakes a sleeping host, so sleep_cpu() returns at once.
+ */ 
+
+
+#ifndef HOST_AVR_SLEEP_H_
+#define HOST_AVR_SLEEP_H_
+
+#include "../host_hal.h"
+
+#define SLEEP_MODE_IDLE			0
+#define SLEEP_MODE_PWR_DOWN		(_BV(SM1))
+
+#define set_sleep_mode(mode)	(SMCR = (uint8_t)((SMCR & ~(_BV(SM0) | _BV(SM1) | _BV(SM2))) | (mode)))
+#define sleep_enable()			(SMCR |= _BV(SE))
+#define sleep_disable()			(SMCR &= (uint8_t)~_BV(SE))
+#define sleep_cpu()				((void)0)
+
+#endif /* HOST_AVR_SLEEP_H_ */
@@ -0,0 +1,27 @@
+/*
+ * avr/wdt.h (host build)
+ *
+ * Created: 10/17/2026 9:12:40 AM
+ *  Author: Bibek Shrestha
+ */ 
+
+
+#ifndef HOST_AVR_WDT_H_
+#define HOST_AVR_WDT_H_
+
+#include "../host_hal.h"
+
+#define WDTO_15MS	0
+#define WDTO_30MS	1
+#define WDTO_60MS	2
+#define WDTO_120MS	3
+#define WDTO_250MS	4
+#define WDTO_500MS	5
+#define WDTO_1S		6
+#define WDTO_2S		7
+
+#define wdt_reset()			((void)0)
+#define wdt_enable(value)	(WDTCSR = (uint8_t)(0x08 | (value)))
+#define wdt_disable()		(WDTCSR = 0)
+
+#endif /* HOST_AVR_WDT_H_ */
@@ -0,0 +1,84 @@
+/*
+ * host_hal.cpp
+ *
+ * Created: 10/17/2026 9:12:40 AM
+ *  Author: Bibek Shrestha
+ */ 
+
+
+#include "host_hal.h"
+
+uint8_t host_io[HOST_IO_SIZE] __attribute__((aligned(2)));
+uint8_t host_eeprom[E2END + 1];
+double  host_delay_us;
+
+
+void host_reset(void)
+{
+	memset(host_io, 0, sizeof(host_io));
+	memset(host_eeprom, 0xFF, sizeof(host_eeprom));
+	host_delay_us = 0;
+}
+
+void host_eeprom_tick(void)
+{
+	if ((EECR & (_BV(EEMPE) | _BV(EEPE))) == (_BV(EEMPE) | _BV(EEPE)))
+		host_eeprom[EEAR & E2END] = EEDR;
+	EECR &= ~(_BV(EEMPE) | _BV(EEPE));
+}
+
+
+/* avr-libc semantics: only radix 10 prints a sign, others show the raw bits */
+extern "C" char *utoa(unsigned int val, char *s, int radix)
+{
+	char tmp[17];
+	char *p = tmp;
+	char *d = s;
+
+	do
+	{
+		unsigned int digit = val % radix;
+		*p++ = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+		val /= radix;
+	} while (val);
+
+	while (p != tmp)
+		*d++ = *--p;
+	*d = '\0';
+	return s;
+}
+
+extern "C" char *itoa(int val, char *s, int radix)
+{
+	if (radix == 10 && val < 0)
+	{
+		*s = '-';
+		utoa(0u - (unsigned int)val, s + 1, radix);
+		return s;
+	}
+	return utoa((unsigned int)(val & 0xFFFF), s, radix);
+}
+
+/* 32 bit long as on the AVR; radix 10 only */
+extern "C" char *ltoa(long val, char *s, int radix)
+{
+	int32_t v = (int32_t)val;
+	uint32_t magnitude = v < 0 ? 0u - (uint32_t)v : (uint32_t)v;
+	char tmp[11];
+	char *p = tmp;
+	char *d = s;
+
+	(void)radix;
+	if (v < 0)
+		*d++ = '-';
+	do
+	{
+		*p++ = (char)('0' + magnitude % 10);
+		magnitude /= 10;
+	} while (magnitude);
+
+	while (p != tmp)
+		*d++ = *--p;
+	*d = '\0';
+	return s;
+}
@@ -0,0 +1,684 @@
+/*
+ * host_hal.h
+ *
+ * Created: 10/17/2026 9:12:40 AM
+ *  Author: Bibek Shrestha
+ *
+ * Register level model of the ATmega2560 used by the host build. The
+ * firmware sources include <avr/io.h> and friends as usual; host/hal is
+ * put first on the include path so they land here instead.
+ *
+ * Every I/O register lives in host_io[] at its real data space address,
+ * so tricks like DDR(x) (*(&x - 1)) in lcd.h keep working. ISR(vect)
+ * defines a plain extern "C" function named after the vector, which the
+ * bench code calls directly to play the interrupt.
+ */
+
+
+#ifndef HOST_HAL_H_
+#define HOST_HAL_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#ifndef __AVR_ATmega2560__
+#define __AVR_ATmega2560__
+#endif
+
+#define HOST_IO_SIZE	0x200
+#define RAMEND			0x21FF
+#define E2END			0x0FFF
+
+extern uint8_t host_io[HOST_IO_SIZE];
+extern double  host_delay_us;	/* time the firmware spent in _delay_us/_delay_ms */
+
+void host_reset(void);
+
+/* ends an EEPROM write started with EEMPE, EEPE: EEDR lands at EEAR */
+void host_eeprom_tick(void);
+
+#define _SFR_MEM8(addr)		(*(volatile uint8_t  *)&host_io[(addr)])
+#define _SFR_MEM16(addr)	(*(volatile uint16_t *)&host_io[(addr)])
+#define _BV(bit)			(1 << (bit))
+
+#define bit_is_set(sfr, bit)	((sfr) & _BV(bit))
+#define bit_is_clear(sfr, bit)	(!((sfr) & _BV(bit)))
+
+
+/* ports */
+#define PINA		_SFR_MEM8(0x020)
+#define DDRA		_SFR_MEM8(0x021)
+#define PORTA		_SFR_MEM8(0x022)
+#define PINB		_SFR_MEM8(0x023)
+#define DDRB		_SFR_MEM8(0x024)
+#define PORTB		_SFR_MEM8(0x025)
+#define PINC		_SFR_MEM8(0x026)
+#define DDRC		_SFR_MEM8(0x027)
+#define PORTC		_SFR_MEM8(0x028)
+#define PIND		_SFR_MEM8(0x029)
+#define DDRD		_SFR_MEM8(0x02A)
+#define PORTD		_SFR_MEM8(0x02B)
+#define PINE		_SFR_MEM8(0x02C)
+#define DDRE		_SFR_MEM8(0x02D)
+#define PORTE		_SFR_MEM8(0x02E)
+#define PINF		_SFR_MEM8(0x02F)
+#define DDRF		_SFR_MEM8(0x030)
+#define PORTF		_SFR_MEM8(0x031)
+#define PING		_SFR_MEM8(0x032)
+#define DDRG		_SFR_MEM8(0x033)
+#define PORTG		_SFR_MEM8(0x034)
+#define PINH		_SFR_MEM8(0x100)
+#define DDRH		_SFR_MEM8(0x101)
+#define PORTH		_SFR_MEM8(0x102)
+#define PINJ		_SFR_MEM8(0x103)
+#define DDRJ		_SFR_MEM8(0x104)
+#define PORTJ		_SFR_MEM8(0x105)
+#define PINK		_SFR_MEM8(0x106)
+#define DDRK		_SFR_MEM8(0x107)
+#define PORTK		_SFR_MEM8(0x108)
+#define PINL		_SFR_MEM8(0x109)
+#define DDRL		_SFR_MEM8(0x10A)
+#define PORTL		_SFR_MEM8(0x10B)
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+/* core */
+#define TIFR0		_SFR_MEM8(0x35)
+#define TIFR1		_SFR_MEM8(0x36)
+#define TIFR2		_SFR_MEM8(0x37)
+#define TIFR3		_SFR_MEM8(0x38)
+#define TIFR4		_SFR_MEM8(0x39)
+#define TIFR5		_SFR_MEM8(0x3A)
+#define PCIFR		_SFR_MEM8(0x3B)
+#define EIFR		_SFR_MEM8(0x3C)
+#define EIMSK		_SFR_MEM8(0x3D)
+#define GPIOR0		_SFR_MEM8(0x3E)
+#define EECR		_SFR_MEM8(0x3F)
+#define EEDR		_SFR_MEM8(0x40)
+#define EEAR		_SFR_MEM16(0x41)
+#define EEARL		_SFR_MEM8(0x41)
+#define EEARH		_SFR_MEM8(0x42)
+#define GTCCR		_SFR_MEM8(0x43)
+#define TCCR0A		_SFR_MEM8(0x44)
+#define TCCR0B		_SFR_MEM8(0x45)
+#define TCNT0		_SFR_MEM8(0x46)
+#define OCR0A		_SFR_MEM8(0x47)
+#define OCR0B		_SFR_MEM8(0x48)
+#define GPIOR1		_SFR_MEM8(0x4A)
+#define GPIOR2		_SFR_MEM8(0x4B)
+#define SMCR		_SFR_MEM8(0x53)
+#define MCUSR		_SFR_MEM8(0x54)
+#define MCUCR		_SFR_MEM8(0x55)
+#define SREG		_SFR_MEM8(0x5F)
+#define WDTCSR		_SFR_MEM8(0x60)
+#define PCICR		_SFR_MEM8(0x68)
+#define EICRA		_SFR_MEM8(0x69)
+#define EICRB		_SFR_MEM8(0x6A)
+#define PCMSK0		_SFR_MEM8(0x6B)
+#define PCMSK1		_SFR_MEM8(0x6C)
+#define PCMSK2		_SFR_MEM8(0x6D)
+#define TIMSK0		_SFR_MEM8(0x6E)
+#define TIMSK1		_SFR_MEM8(0x6F)
+#define TIMSK2		_SFR_MEM8(0x70)
+#define TIMSK3		_SFR_MEM8(0x71)
+#define TIMSK4		_SFR_MEM8(0x72)
+#define TIMSK5		_SFR_MEM8(0x73)
+
+
+/* 16 bit timers */
+#define TCCR1A		_SFR_MEM8(0x80)
+#define TCCR1B		_SFR_MEM8(0x81)
+#define TCCR1C		_SFR_MEM8(0x82)
+#define TCNT1		_SFR_MEM16(0x84)
+#define ICR1		_SFR_MEM16(0x86)
+#define OCR1A		_SFR_MEM16(0x88)
+#define OCR1B		_SFR_MEM16(0x8A)
+#define OCR1C		_SFR_MEM16(0x8C)
+
+#define TCCR3A		_SFR_MEM8(0x90)
+#define TCCR3B		_SFR_MEM8(0x91)
+#define TCCR3C		_SFR_MEM8(0x92)
+#define TCNT3		_SFR_MEM16(0x94)
+#define ICR3		_SFR_MEM16(0x96)
+#define OCR3A		_SFR_MEM16(0x98)
+#define OCR3B		_SFR_MEM16(0x9A)
+#define OCR3C		_SFR_MEM16(0x9C)
+
+#define TCCR4A		_SFR_MEM8(0xA0)
+#define TCCR4B		_SFR_MEM8(0xA1)
+#define TCCR4C		_SFR_MEM8(0xA2)
+#define TCNT4		_SFR_MEM16(0xA4)
+#define ICR4		_SFR_MEM16(0xA6)
+#define OCR4A		_SFR_MEM16(0xA8)
+#define OCR4B		_SFR_MEM16(0xAA)
+#define OCR4C		_SFR_MEM16(0xAC)
+
+#define TCCR5A		_SFR_MEM8(0x120)
+#define TCCR5B		_SFR_MEM8(0x121)
+#define TCCR5C		_SFR_MEM8(0x122)
+#define TCNT5		_SFR_MEM16(0x124)
+#define TCNT5L		_SFR_MEM8(0x124)
+#define ICR5		_SFR_MEM16(0x126)
+#define OCR5A		_SFR_MEM16(0x128)
+#define OCR5B		_SFR_MEM16(0x12A)
+#define OCR5C		_SFR_MEM16(0x12C)
+
+#define TCCR2A		_SFR_MEM8(0xB0)
+#define TCCR2B		_SFR_MEM8(0xB1)
+#define TCNT2		_SFR_MEM8(0xB2)
+#define OCR2A		_SFR_MEM8(0xB3)
+#define OCR2B		_SFR_MEM8(0xB4)
+
+
+/* USARTs */
+#define UCSR0A		_SFR_MEM8(0xC0)
+#define UCSR0B		_SFR_MEM8(0xC1)
+#define UCSR0C		_SFR_MEM8(0xC2)
+#define UBRR0L		_SFR_MEM8(0xC4)
+#define UBRR0H		_SFR_MEM8(0xC5)
+#define UDR0		_SFR_MEM8(0xC6)
+
+#define UCSR1A		_SFR_MEM8(0xC8)
+#define UCSR1B		_SFR_MEM8(0xC9)
+#define UCSR1C		_SFR_MEM8(0xCA)
+#define UBRR1L		_SFR_MEM8(0xCC)
+#define UBRR1H		_SFR_MEM8(0xCD)
+#define UDR1		_SFR_MEM8(0xCE)
+
+#define UCSR2A		_SFR_MEM8(0xD0)
+#define UCSR2B		_SFR_MEM8(0xD1)
+#define UCSR2C		_SFR_MEM8(0xD2)
+#define UBRR2L		_SFR_MEM8(0xD4)
+#define UBRR2H		_SFR_MEM8(0xD5)
+#define UDR2		_SFR_MEM8(0xD6)
+
+#define UCSR3A		_SFR_MEM8(0x130)
+#define UCSR3B		_SFR_MEM8(0x131)
+#define UCSR3C		_SFR_MEM8(0x132)
+#define UBRR3L		_SFR_MEM8(0x134)
+#define UBRR3H		_SFR_MEM8(0x135)
+#define UDR3		_SFR_MEM8(0x136)
+
+
+/* register bits */
+#define ISC00	0
+#define ISC01	1
+#define ISC10	2
+#define ISC11	3
+#define ISC20	4
+#define ISC21	5
+#define ISC30	6
+#define ISC31	7
+#define ISC40	0
+#define ISC41	1
+#define ISC50	2
+#define ISC51	3
+#define ISC60	4
+#define ISC61	5
+#define ISC70	6
+#define ISC71	7
+
+#define INT0	0
+#define INT1	1
+#define INT2	2
+#define INT3	3
+#define INT4	4
+#define INT5	5
+#define INT6	6
+#define INT7	7
+
+#define INTF0	0
+#define INTF1	1
+#define INTF2	2
+#define INTF3	3
+#define INTF4	4
+#define INTF5	5
+#define INTF6	6
+#define INTF7	7
+
+#define PCIE0	0
+#define PCIE1	1
+#define PCIE2	2
+#define PCIF2	2
+
+#define PCINT16	0
+#define PCINT17	1
+#define PCINT18	2
+#define PCINT19	3
+#define PCINT20	4
+#define PCINT21	5
+#define PCINT22	6
+#define PCINT23	7
+
+#define TOIE0	0
+#define OCIE0A	1
+#define OCIE0B	2
+#define TOV0	0
+#define OCF0A	1
+#define OCF0B	2
+#define CS00	0
+#define CS01	1
+#define CS02	2
+#define WGM00	0
+#define WGM01	1
+#define WGM02	3
+
+#define TOIE2	0
+#define OCIE2A	1
+#define OCIE2B	2
+#define CS20	0
+#define CS21	1
+#define CS22	2
+#define WGM20	0
+#define WGM21	1
+
+#define TOIE1	0
+#define OCIE1A	1
+#define OCIE1B	2
+#define ICIE1	5
+#define TOV1	0
+#define OCF1A	1
+#define ICF1	5
+#define CS10	0
+#define CS11	1
+#define CS12	2
+#define WGM12	3
+#define ICES1	6
+#define ICNC1	7
+
+#define TOIE3	0
+#define OCIE3A	1
+#define ICIE3	5
+#define TOV3	0
+#define OCF3A	1
+#define ICF3	5
+#define CS30	0
+#define CS31	1
+#define CS32	2
+#define WGM32	3
+#define ICES3	6
+#define ICNC3	7
+
+#define TOIE4	0
+#define OCIE4A	1
+#define ICIE4	5
+#define TOV4	0
+#define OCF4A	1
+#define ICF4	5
+#define CS40	0
+#define CS41	1
+#define CS42	2
+#define WGM42	3
+#define ICES4	6
+#define ICNC4	7
+
+#define TOIE5	0
+#define OCIE5A	1
+#define ICIE5	5
+#define TOV5	0
+#define OCF5A	1
+#define ICF5	5
+#define CS50	0
+#define CS51	1
+#define CS52	2
+#define WGM52	3
+#define ICES5	6
+#define ICNC5	7
+
+#define MPCM0	0
+#define U2X0	1
+#define UPE0	2
+#define DOR0	3
+#define FE0		4
+#define UDRE0	5
+#define TXC0	6
+#define RXC0	7
+#define TXEN0	3
+#define RXEN0	4
+#define UDRIE0	5
+#define TXCIE0	6
+#define RXCIE0	7
+#define UCSZ00	1
+#define UCSZ01	2
+
+#define U2X1	1
+#define DOR1	3
+#define FE1		4
+#define TXEN1	3
+#define RXEN1	4
+#define UDRIE1	5
+#define RXCIE1	7
+#define UCSZ10	1
+#define UCSZ11	2
+
+#define U2X2	1
+#define DOR2	3
+#define FE2		4
+#define TXEN2	3
+#define RXEN2	4
+#define UDRIE2	5
+#define RXCIE2	7
+#define UCSZ20	1
+#define UCSZ21	2
+
+#define U2X3	1
+#define DOR3	3
+#define FE3		4
+#define TXEN3	3
+#define RXEN3	4
+#define UDRIE3	5
+#define RXCIE3	7
+#define UCSZ30	1
+#define UCSZ31	2
+
+#define EERE	0
+#define EEPE	1
+#define EEMPE	2
+#define EERIE	3
+
+#define SE		0
+#define SM0		1
+#define SM1		2
+#define SM2		3
+
+#define PORF	0
+#define EXTRF	1
+#define BORF	2
+#define WDRF	3
+
+#define SREG_I	7
+
+
+/* pin numbers */
+#define PINA0	0
+#define PINA1	1
+#define PINA2	2
+#define PINA3	3
+#define PINA4	4
+#define PINA5	5
+#define PINA6	6
+#define PINA7	7
+#define DDA0	0
+#define DDA1	1
+#define DDA2	2
+#define DDA3	3
+#define DDA4	4
+#define DDA5	5
+#define DDA6	6
+#define DDA7	7
+#define PORTA0	0
+#define PORTA1	1
+#define PORTA2	2
+#define PORTA3	3
+#define PORTA4	4
+#define PORTA5	5
+#define PORTA6	6
+#define PORTA7	7
+#define PINB0	0
+#define PINB1	1
+#define PINB2	2
+#define PINB3	3
+#define PINB4	4
+#define PINB5	5
+#define PINB6	6
+#define PINB7	7
+#define DDB0	0
+#define DDB1	1
+#define DDB2	2
+#define DDB3	3
+#define DDB4	4
+#define DDB5	5
+#define DDB6	6
+#define DDB7	7
+#define PORTB0	0
+#define PORTB1	1
+#define PORTB2	2
+#define PORTB3	3
+#define PORTB4	4
+#define PORTB5	5
+#define PORTB6	6
+#define PORTB7	7
+#define PINC0	0
+#define PINC1	1
+#define PINC2	2
+#define PINC3	3
+#define PINC4	4
+#define PINC5	5
+#define PINC6	6
+#define PINC7	7
+#define DDC0	0
+#define DDC1	1
+#define DDC2	2
+#define DDC3	3
+#define DDC4	4
+#define DDC5	5
+#define DDC6	6
+#define DDC7	7
+#define PORTC0	0
+#define PORTC1	1
+#define PORTC2	2
+#define PORTC3	3
+#define PORTC4	4
+#define PORTC5	5
+#define PORTC6	6
+#define PORTC7	7
+#define PIND0	0
+#define PIND1	1
+#define PIND2	2
+#define PIND3	3
+#define PIND4	4
+#define PIND5	5
+#define PIND6	6
+#define PIND7	7
+#define DDD0	0
+#define DDD1	1
+#define DDD2	2
+#define DDD3	3
+#define DDD4	4
+#define DDD5	5
+#define DDD6	6
+#define DDD7	7
+#define PORTD0	0
+#define PORTD1	1
+#define PORTD2	2
+#define PORTD3	3
+#define PORTD4	4
+#define PORTD5	5
+#define PORTD6	6
+#define PORTD7	7
+#define PINE0	0
+#define PINE1	1
+#define PINE2	2
+#define PINE3	3
+#define PINE4	4
+#define PINE5	5
+#define PINE6	6
+#define PINE7	7
+#define DDE0	0
+#define DDE1	1
+#define DDE2	2
+#define DDE3	3
+#define DDE4	4
+#define DDE5	5
+#define DDE6	6
+#define DDE7	7
+#define PORTE0	0
+#define PORTE1	1
+#define PORTE2	2
+#define PORTE3	3
+#define PORTE4	4
+#define PORTE5	5
+#define PORTE6	6
+#define PORTE7	7
+#define PINF0	0
+#define PINF1	1
+#define PINF2	2
+#define PINF3	3
+#define PINF4	4
+#define PINF5	5
+#define PINF6	6
+#define PINF7	7
+#define DDF0	0
+#define DDF1	1
+#define DDF2	2
+#define DDF3	3
+#define DDF4	4
+#define DDF5	5
+#define DDF6	6
+#define DDF7	7
+#define PORTF0	0
+#define PORTF1	1
+#define PORTF2	2
+#define PORTF3	3
+#define PORTF4	4
+#define PORTF5	5
+#define PORTF6	6
+#define PORTF7	7
+#define PING0	0
+#define PING1	1
+#define PING2	2
+#define PING3	3
+#define PING4	4
+#define PING5	5
+#define PING6	6
+#define PING7	7
+#define DDG0	0
+#define DDG1	1
+#define DDG2	2
+#define DDG3	3
+#define DDG4	4
+#define DDG5	5
+#define DDG6	6
+#define DDG7	7
+#define PORTG0	0
+#define PORTG1	1
+#define PORTG2	2
+#define PORTG3	3
+#define PORTG4	4
+#define PORTG5	5
+#define PORTG6	6
+#define PORTG7	7
+#define PINH0	0
+#define PINH1	1
+#define PINH2	2
+#define PINH3	3
+#define PINH4	4
+#define PINH5	5
+#define PINH6	6
+#define PINH7	7
+#define DDH0	0
+#define DDH1	1
+#define DDH2	2
+#define DDH3	3
+#define DDH4	4
+#define DDH5	5
+#define DDH6	6
+#define DDH7	7
+#define PORTH0	0
+#define PORTH1	1
+#define PORTH2	2
+#define PORTH3	3
+#define PORTH4	4
+#define PORTH5	5
+#define PORTH6	6
+#define PORTH7	7
+#define PINJ0	0
+#define PINJ1	1
+#define PINJ2	2
+#define PINJ3	3
+#define PINJ4	4
+#define PINJ5	5
+#define PINJ6	6
+#define PINJ7	7
+#define DDJ0	0
+#define DDJ1	1
+#define DDJ2	2
+#define DDJ3	3
+#define DDJ4	4
+#define DDJ5	5
+#define DDJ6	6
+#define DDJ7	7
+#define PORTJ0	0
+#define PORTJ1	1
+#define PORTJ2	2
+#define PORTJ3	3
+#define PORTJ4	4
+#define PORTJ5	5
+#define PORTJ6	6
+#define PORTJ7	7
+#define PINK0	0
+#define PINK1	1
+#define PINK2	2
+#define PINK3	3
+#define PINK4	4
+#define PINK5	5
+#define PINK6	6
+#define PINK7	7
+#define DDK0	0
+#define DDK1	1
+#define DDK2	2
+#define DDK3	3
+#define DDK4	4
+#define DDK5	5
+#define DDK6	6
+#define DDK7	7
+#define PORTK0	0
+#define PORTK1	1
+#define PORTK2	2
+#define PORTK3	3
+#define PORTK4	4
+#define PORTK5	5
+#define PORTK6	6
+#define PORTK7	7
+#define PINL0	0
+#define PINL1	1
+#define PINL2	2
+#define PINL3	3
+#define PINL4	4
+#define PINL5	5
+#define PINL6	6
+#define PINL7	7
+#define DDL0	0
+#define DDL1	1
+#define DDL2	2
+#define DDL3	3
+#define DDL4	4
+#define DDL5	5
+#define DDL6	6
+#define DDL7	7
+#define PORTL0	0
+#define PORTL1	1
+#define PORTL2	2
+#define PORTL3	3
+#define PORTL4	4
+#define PORTL5	5
+#define PORTL6	6
+#define PORTL7	7
+
+
+/* interrupts */
+#define ISR(vector, ...)	extern "C" void vector(void); extern "C" void vector(void)
+#define HOST_VECTOR(vector)	extern "C" void vector(void)
+
+#define sei()	(SREG |=  _BV(SREG_I))
+#define cli()	(SREG &= ~_BV(SREG_I))
+
+
+/* avr-libc <stdlib.h> extras */
+extern "C" char *itoa(int val, char *s, int radix);
+extern "C" char *utoa(unsigned int val, char *s, int radix);
+extern "C" char *ltoa(long val, char *s, int radix);
+
+
+#endif /* HOST_HAL_H_ */
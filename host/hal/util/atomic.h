@@ -0,0 +1,33 @@
+/*
+ * util/atomic.h (host build)
+ *
+ * Created: 10/17/2026 3:05:44 PM
+ *  Author: Bibek Shrestha
+ *
+ * Same shape as avr-libc: the body runs once with the I bit clear and
+ * SREG is put back on the way out. ATOMIC_FORCEON behaves like
+ * ATOMIC_RESTORESTATE here, which only differs if the block is entered
+ * with interrupts off.
+ */ 
+
+
+#ifndef HOST_UTIL_ATOMIC_H_
+#define HOST_UTIL_ATOMIC_H_
+
+#include "../host_hal.h"
+
+static inline uint8_t host_atomic_enter(void)
+{
+	uint8_t sreg = SREG;
+	cli();
+	return sreg;
+}
+
+#define ATOMIC_RESTORESTATE		uint8_t host_sreg_save
+#define ATOMIC_FORCEON			uint8_t host_sreg_save
+
+#define ATOMIC_BLOCK(type) \
+	for (type = host_atomic_enter(), host_atomic_once = 1; \
+		 host_atomic_once; SREG = host_sreg_save, host_atomic_once = 0)
+
+#endif /* HOST_UTIL_ATOMIC_H_ */
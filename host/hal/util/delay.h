@@ -0,0 +1,28 @@
+/*
+ * util/delay.h (host build)
+ *
+ * Created: 10/17/2026 9:12:40 AM
+ *  Author: Bibek Shrestha
+ *
+ * Busy waits do not spin on the host. The requested time is added to
+ * host_delay_us so benchmarks can report how long the target would
+ * have blocked.
+ */ 
+
+
+#ifndef HOST_UTIL_DELAY_H_
+#define HOST_UTIL_DELAY_H_
+
+#include "../host_hal.h"
+
+static inline void _delay_us(double us)
+{
+	host_delay_us += us;
+}
+
+static inline void _delay_ms(double ms)
+{
+	host_delay_us += ms * 1000.0;
+}
+
+#endif /* HOST_UTIL_DELAY_H_ */
@@ -0,0 +1,176 @@
+/*
+ * motor_sim.cpp
+ *
+ * Created: 10/18/2026 12:31:05 AM
+ *  Author: Bibek Shrestha
+ */
+
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "motor_sim.h"
+#include "rpmfilter.h"
+
+/* PID.cpp output limit and Timer0 overflow period (clk/256, 8 bit) */
+#define SIM_MAX_OUTPUT			1400
+#define SIM_TIMER0_PERIOD_S		(256.0 * 256.0 / F_CPU)
+
+
+/* xorshift32: the same jitter on every run, no state shared between threads */
+static int jitter(uint32_t &state, int range)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return range ? (int)(state % (2 * range + 1)) - range : 0;
+}
+
+/* the first step measured is the start-up, the second the setpoint change */
+static void keep(SimResult &result, int &kept, const StepResult &done)
+{
+	if (kept == 0)
+		result.step = done;
+	else if (kept == 1)
+		result.change = done;
+	++kept;
+}
+
+SimResult motor_simulate(const MotorModel &model, const SimProfile &profile,
+						 const StepConfig &metrics, PID &pid, FILE *trace)
+{
+	SimResult result;
+	StepResponse response(metrics);
+	StepResult done;
+	int kept = 0;
+
+	const double countsPerS = F_CPU / model.prescaler;
+	const double countsPerMinute = 60.0 * countsPerS / model.pulsesPerRev;
+	const double controlS = model.controlMs / 1000.0;
+
+	double rpm = 0;					/* true speed */
+	double phase = 0;				/* fraction of a pulse turned since the last edge */
+	double counts = 0;				/* RPM timer since the last edge */
+	int measured = 0;
+	int output = 0;
+	double nextTimer0 = SIM_TIMER0_PERIOD_S;
+	double nextControl = 0;
+	bool dipped = false;
+	bool changed = false;
+	bool outside = false;
+	double dipTime = 0;
+	RpmFilter filter = RpmFilter();
+	uint32_t noise = 2463534242u;
+	const double tailS = profile.seconds > 2 ? profile.seconds - 1 : profile.seconds / 2;
+	double outputSteps = 0;
+	long tailSamples = 0;
+	int lastOutput = 0;
+
+	result.step = StepResult();
+	result.change = StepResult();
+	result.maxOutputSeen = 0;
+	result.recoverMs = -1;
+	result.chatter = 0;
+	pid.Set_Setpoint(profile.setpoint);
+#if PID_TRAJECTORY
+	pid.Reset_Reference(0);				/* from rest */
+#endif
+	response.add(0, false, 0, 0, done);		/* at rest, so t = 0 is a step */
+
+	long steps = (long)(profile.seconds / model.dtS);
+	for (long n = 0; n <= steps; ++n)
+	{
+		double t = n * model.dtS;
+
+		if (t >= nextTimer0)
+		{
+			++pid.timer;
+			nextTimer0 += SIM_TIMER0_PERIOD_S;
+		}
+
+		if (!changed && profile.changeAtS >= 0 && t >= profile.changeAtS)
+		{
+			pid.Set_Setpoint(profile.changeTo);
+			changed = true;
+		}
+
+		if (t >= nextControl)
+		{
+			output = pid.Compute_PID(measured, model.lowFlag);
+			if (abs(output) > result.maxOutputSeen)
+				result.maxOutputSeen = abs(output);
+
+			if (!dipped && response.add(t * 1000, true, measured, pid.Get_Setpoint(), done))
+				keep(result, kept, done);
+
+			if (dipped && result.recoverMs < 0)
+			{
+				int band = (int)(pid.Get_Setpoint() * metrics.bandPct / 100.0);
+				if (band < metrics.bandMin)
+					band = metrics.bandMin;
+				if (abs(measured - pid.Get_Setpoint()) > band)
+					outside = true;
+				else if (outside)
+					result.recoverMs = (t - dipTime) * 1000;
+			}
+			if (t >= tailS)
+			{
+				if (tailSamples)
+					outputSteps += abs(output - lastOutput);
+				++tailSamples;
+			}
+			lastOutput = output;
+			if (trace)
+				fprintf(trace, "%.1f %.1f %d %d\n", t * 1000, rpm, measured, output);
+			nextControl += controlS;
+		}
+
+		if (!dipped && profile.dipAtS >= 0 && t >= profile.dipAtS)
+		{
+			rpm = rpm > profile.dipRpm ? rpm - profile.dipRpm : 0;
+			/* the step in progress ends here */
+			if (response.finish(done))
+				keep(result, kept, done);
+			dipped = true;
+			dipTime = t;
+		}
+
+		/* motor */
+		double target = model.noLoadRpm * output / SIM_MAX_OUTPUT;
+		double accel = (target - rpm) / model.tauS;
+		if (rpm > 0)
+			accel -= model.frictionRpmPerS + model.dragAt1000Rpm * (rpm / 1000) * (rpm / 1000);
+		else if (accel < 0)
+			accel = 0;				/* no reversing through friction */
+		rpm += accel * model.dtS;
+		if (rpm < 0)
+			rpm = 0;
+
+		/* sensor: edges latch the timer count since the previous one */
+		counts += countsPerS * model.dtS;
+		phase += rpm / 60.0 * model.pulsesPerRev * model.dtS;
+		if (phase >= 1.0)
+		{
+			/* back off to where the edge fell inside this step */
+			double late = (phase - 1.0) / (rpm / 60.0 * model.pulsesPerRev) * countsPerS;
+			uint16_t count = (uint16_t)(counts - late + jitter(noise, model.jitterCounts));
+			if (model.filter)
+				count = rpm_filter_step(filter, count);
+			measured = count ? (int)(countsPerMinute / count) : 0;
+			counts = late;
+			phase -= 1.0;
+		}
+		if (counts >= 65536.0)
+		{
+			measured = 0;			/* TIMERn_OVF_vect */
+			rpm_filter_reset(filter);
+			counts -= 65536.0;
+		}
+	}
+
+	if (!dipped && response.finish(done))
+		keep(result, kept, done);
+	if (tailSamples > 1)
+		result.chatter = outputSteps / (tailSamples - 1);
+	return result;
+}
@@ -0,0 +1,85 @@
+/*
+ * motor_sim.h
+ *
+ * Created: 10/18/2026 12:31:05 AM
+ *  Author: Bibek Shrestha
+ *
+ * Closed loop of one flywheel motor around the firmware's PID class, for
+ * tuning gains on the host.
+ *
+ *   motor    first order DC motor + flywheel: speed heads for
+ *            noLoadRpm * output / MAX_OUTPUT with time constant tauS,
+ *            less a constant friction and an air drag growing with the
+ *            square of the speed
+ *   sensor   pulsesPerRev edges per turn timestamped by a 16 bit timer
+ *            at F_CPU / prescaler, as MOTORxxx_TCNT is read in the INTn
+ *            ISR; RPM = 60 * F_CPU / prescaler / pulses / Count, integer,
+ *            refreshed only at an edge, 0 once the timer overflows; each
+ *            count off by up to jitterCounts either way, and through the
+ *            RPM ISRs' filter (rpmfilter.h) with filter set
+ *   PID      Compute_PID() called every controlMs like ControlTask, with
+ *            PID::timer advanced by a Timer0 overflow every 4.096 ms
+ *            (clk/256), so LowFlag gating behaves as on the board
+ *
+ * The motor is integrated in dtS steps. Everything is per call, so runs
+ * on separate threads share nothing.
+ */
+
+
+#ifndef MOTOR_SIM_H_
+#define MOTOR_SIM_H_
+
+#include <stdio.h>
+
+#include "PID.h"
+#include "step_response.h"
+
+struct MotorModel
+{
+	double noLoadRpm;			/* at output = MAX_OUTPUT */
+	double tauS;				/* mechanical time constant */
+	double frictionRpmPerS;		/* constant deceleration while turning */
+	double dragAt1000Rpm;		/* drag deceleration at 1000 rpm, rpm/s */
+	double prescaler;			/* RPM timer */
+	int    pulsesPerRev;
+	double controlMs;			/* Compute_PID period */
+	bool   lowFlag;				/* Compute_PID(.., LowFlag) */
+	double dtS;
+	int    jitterCounts;		/* edge timing noise, uniform */
+	bool   filter;
+
+	MotorModel()
+		: noLoadRpm(5000), tauS(0.35), frictionRpmPerS(150), dragAt1000Rpm(40),
+		  prescaler(64), pulsesPerRev(1), controlMs(4), lowFlag(false), dtS(1e-4),
+		  jitterCounts(0), filter(false) {}
+};
+
+struct SimProfile
+{
+	int    setpoint;			/* step from rest at t = 0 */
+	double seconds;
+	double dipAtS;				/* a disc launch: speed drops by dipRpm, < 0 for none */
+	int    dipRpm;
+	double changeAtS;			/* setpoint moves to changeTo, < 0 for none */
+	int    changeTo;
+
+	SimProfile() : setpoint(1500), seconds(3.0), dipAtS(-1), dipRpm(300), changeAtS(-1), changeTo(2000) {}
+};
+
+struct SimResult
+{
+	StepResult step;			/* the start-up step, on the measured RPM */
+	StepResult change;			/* the step at changeAtS, if before the dip */
+	int    maxOutputSeen;
+	double recoverMs;			/* after the dip, back within the band; < 0 if never */
+	double chatter;				/* last second: mean |output change| per control period */
+};
+
+/*
+ * pid must be Initialise()d and have its gains set. trace, if given,
+ * gets one "t_ms true_rpm measured_rpm output" line per control period.
+ */
+SimResult motor_simulate(const MotorModel &model, const SimProfile &profile,
+						 const StepConfig &metrics, PID &pid, FILE *trace = 0);
+
+#endif /* MOTOR_SIM_H_ */
@@ -0,0 +1,306 @@
+/*
+ * pid_sweep.cpp
+ *
+ * Created: 10/18/2026 12:31:05 AM
+ *  Author: Bibek Shrestha
+ *
+ * Grid search of the flywheel PID gains on the host (motor_sim.h): every
+ * kp/ki/kd combination is run as a start-up step, spread over all cores,
+ * and ranked by settling time plus a penalty per percent of overshoot;
+ * candidates that never settle come last. The firmware's own gains
+ * (VG_KP/VG_KI/VG_KD in PID.cpp) are run too as the baseline, and with
+ * fixed point the gain schedule (pid_schedule[]) as "scheduled".
+ *
+ *   pid_sweep [-p kp_min:kp_max:n] [-i ki_min:ki_max:n] [-d kd_min:kd_max:n]
+ *             [-s setpoint] [-T seconds] [-j threads] [-n top] [-w ms_per_pct]
+ *             [-N no_load_rpm] [-t tau_s] [-P prescaler] [-e pulses_per_rev]
+ *             [-L] [-x dip_at_s] [-D dip_rpm] [-c change_at_s:setpoint] [-F]
+ *             [-R rate:accel] [-J jitter_counts] [-M] [-C ms_per_chatter]
+ *             [-o best_trace_file]
+ *
+ * -L calls Compute_PID with LowFlag, so updates are gated to every fifth
+ * Timer0 overflow. -x adds a disc launch to each run and reports the
+ * recovery time; ranking still uses the start-up step. -c moves the
+ * setpoint during each run, and ranking uses that step instead. -F turns
+ * on the feed-forward table (feedforward.h) for every run, and -R the
+ * setpoint trajectory (trajectory.h) with rate RPM/s and accel RPM/s^2.
+ * The settling times count from the setpoint change, ramp included.
+ * -J adds up to that many timer counts of jitter to every RPM period and
+ * -M puts the periods through the RPM ISRs' filter (rpmfilter.h). The
+ * chatter printed is the mean change of the output per control period
+ * over the last second; -C adds it to the cost.
+ */
+
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "motor_sim.h"
+
+/* PID.cpp */
+#define BASELINE_KP		1.07
+#define BASELINE_KI		0.0135
+#define BASELINE_KD		23.87
+
+
+struct Range
+{
+	double min, max;
+	int    count;
+
+	double at(int i) const
+	{
+		return count > 1 ? min + (max - min) * i / (count - 1) : min;
+	}
+};
+
+struct Candidate
+{
+	double    kp, ki, kd;
+	SimResult result;
+	double    cost;
+};
+
+
+static bool parse_range(const char *text, Range &range)
+{
+	return sscanf(text, "%lf:%lf:%d", &range.min, &range.max, &range.count) == 3 && range.count > 0;
+}
+
+static void run_candidate(Candidate &c, const MotorModel &model, const SimProfile &profile,
+						  const StepConfig &metrics, PID pid, double overshootWeight, double chatterWeight,
+						  FILE *trace = 0, bool schedule = false)
+{
+	pid.Set_PID(c.kp, c.ki, c.kd);
+#if PID_GAIN_SCHEDULE
+	if (schedule)
+	{
+		pid.Set_Setpoint(profile.setpoint);
+		pid.Use_Schedule();
+		c.kp = pid.Get_Kp();
+		c.ki = pid.Get_Ki();
+		c.kd = pid.Get_Kd();
+	}
+#else
+	(void)schedule;
+#endif
+	c.result = motor_simulate(model, profile, metrics, pid, trace);
+
+	const StepResult &s = profile.changeAtS >= 0 ? c.result.change : c.result.step;
+	c.cost = s.settled ? s.settleMs + overshootWeight * s.overshootPct + chatterWeight * c.result.chatter : 1e30;
+}
+
+static bool better(const Candidate &a, const Candidate &b)
+{
+	return a.cost < b.cost;
+}
+
+static void print_candidate(const char *label, int rank, const Candidate &c)
+{
+	const StepResult &s = c.result.step;
+
+	printf("%s", label);
+	if (rank)
+		printf(" rank=%d", rank);
+	printf(" kp=%.4f ki=%.5f kd=%.3f", c.kp, c.ki, c.kd);
+	if (s.settled)
+		printf(" settle_ms=%.0f", s.settleMs);
+	else
+		printf(" settle_ms=-");
+	printf(" overshoot_pct=%.1f", s.overshootPct);
+	if (s.risen)
+		printf(" rise_ms=%.0f", s.riseMs);
+	else
+		printf(" rise_ms=-");
+	printf(" sse=%.1f max_output=%d", s.sse, c.result.maxOutputSeen);
+	if (c.result.recoverMs >= 0)
+		printf(" recover_ms=%.0f", c.result.recoverMs);
+	printf(" chatter=%.1f", c.result.chatter);
+
+	const StepResult &m = c.result.change;
+	if (m.samples)
+	{
+		if (m.settled)
+			printf(" change_settle_ms=%.0f", m.settleMs);
+		else
+			printf(" change_settle_ms=-");
+		printf(" change_overshoot_pct=%.1f change_sse=%.1f", m.overshootPct, m.sse);
+	}
+	printf("\n");
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+			"usage: pid_sweep [-p kp_min:kp_max:n] [-i ki_min:ki_max:n] [-d kd_min:kd_max:n]\n"
+			"                 [-s setpoint] [-T seconds] [-j threads] [-n top] [-w ms_per_pct]\n"
+			"                 [-N no_load_rpm] [-t tau_s] [-P prescaler] [-e pulses_per_rev]\n"
+			"                 [-L] [-x dip_at_s] [-D dip_rpm] [-c change_at_s:setpoint] [-F]\n"
+			"                 [-R rate:accel] [-J jitter_counts] [-M] [-C ms_per_chatter]\n"
+			"                 [-o best_trace_file]\n");
+}
+
+int main(int argc, char **argv)
+{
+	Range kp = { 0.5, 2.0, 16 }, ki = { 0.002, 0.03, 16 }, kd = { 0.0, 40.0, 16 };
+	MotorModel model;
+	SimProfile profile;
+	StepConfig metrics;
+	unsigned threads = std::thread::hardware_concurrency();
+	int top = 10;
+	double overshootWeight = 20.0;
+	double chatterWeight = 0.0;
+	const char *tracePath = 0;
+	bool feedForward = false;
+	unsigned rate = 0, accel = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "p:i:d:s:T:j:n:w:N:t:P:e:Lx:D:c:FR:J:MC:o:")) != -1)
+	{
+		switch (opt)
+		{
+		case 'p': if (!parse_range(optarg, kp)) { usage(); return 2; } break;
+		case 'i': if (!parse_range(optarg, ki)) { usage(); return 2; } break;
+		case 'd': if (!parse_range(optarg, kd)) { usage(); return 2; } break;
+		case 's': profile.setpoint = atoi(optarg); break;
+		case 'T': profile.seconds = strtod(optarg, 0); break;
+		case 'j': threads = (unsigned)atoi(optarg); break;
+		case 'n': top = atoi(optarg); break;
+		case 'w': overshootWeight = strtod(optarg, 0); break;
+		case 'N': model.noLoadRpm = strtod(optarg, 0); break;
+		case 't': model.tauS = strtod(optarg, 0); break;
+		case 'P': model.prescaler = strtod(optarg, 0); break;
+		case 'e': model.pulsesPerRev = atoi(optarg); break;
+		case 'L': model.lowFlag = true; break;
+		case 'x': profile.dipAtS = strtod(optarg, 0); break;
+		case 'D': profile.dipRpm = atoi(optarg); break;
+		case 'c':
+			if (sscanf(optarg, "%lf:%d", &profile.changeAtS, &profile.changeTo) != 2)
+			{
+				usage();
+				return 2;
+			}
+			break;
+		case 'F': feedForward = true; break;
+		case 'R':
+			if (sscanf(optarg, "%u:%u", &rate, &accel) != 2 || rate > 0xFFFF || accel > 0xFFFF)
+			{
+				usage();
+				return 2;
+			}
+			break;
+		case 'J': model.jitterCounts = atoi(optarg); break;
+		case 'M': model.filter = true; break;
+		case 'C': chatterWeight = strtod(optarg, 0); break;
+		case 'o': tracePath = optarg; break;
+		default:  usage(); return 2;
+		}
+	}
+	if (optind != argc || model.pulsesPerRev < 1 || model.prescaler <= 0 || model.jitterCounts < 0)
+	{
+		usage();
+		return 2;
+	}
+	if (threads < 1)
+		threads = 1;
+
+	/* PID::Initialise() sets up Timer0, so keep it off the worker threads */
+	PID initial = PID();
+	initial.Initialise();
+#if PID_FEED_FORWARD
+	ff_init();
+	initial.Set_Setpoint(profile.setpoint);
+	initial.Use_Feed_Forward(feedForward);
+#else
+	if (feedForward)
+	{
+		fprintf(stderr, "pid_sweep: no feed-forward in this build\n");
+		return 2;
+	}
+#endif
+#if PID_TRAJECTORY
+	initial.Use_Trajectory((uint16_t)rate, (uint16_t)accel);
+#else
+	if (rate)
+	{
+		fprintf(stderr, "pid_sweep: no trajectory in this build\n");
+		return 2;
+	}
+#endif
+
+	std::vector<Candidate> candidates;
+	candidates.reserve((size_t)kp.count * ki.count * kd.count);
+	for (int a = 0; a < kp.count; ++a)
+		for (int b = 0; b < ki.count; ++b)
+			for (int c = 0; c < kd.count; ++c)
+			{
+				Candidate candidate = Candidate();
+				candidate.kp = kp.at(a);
+				candidate.ki = ki.at(b);
+				candidate.kd = kd.at(c);
+				candidates.push_back(candidate);
+			}
+
+	/* workers take the next candidate until none are left */
+	std::atomic<size_t> next(0);
+	std::vector<std::thread> pool;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (unsigned t = 0; t < threads; ++t)
+	{
+		pool.push_back(std::thread([&]() {
+			for (size_t i = next++; i < candidates.size(); i = next++)
+				run_candidate(candidates[i], model, profile, metrics, initial, overshootWeight, chatterWeight);
+		}));
+	}
+	for (size_t t = 0; t < pool.size(); ++t)
+		pool[t].join();
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::stable_sort(candidates.begin(), candidates.end(), better);
+
+	printf("sweep candidates=%zu threads=%u seconds=%.2f per_candidate_ms=%.2f setpoint=%d sim_s=%.1f feed_forward=%d rate=%u accel=%u jitter=%d filter=%d",
+		   candidates.size(), threads, seconds,
+		   candidates.empty() ? 0.0 : 1000.0 * seconds * threads / candidates.size(),
+		   profile.setpoint, profile.seconds, feedForward, rate, accel, model.jitterCounts, model.filter);
+	if (profile.changeAtS >= 0)
+		printf(" change_at_s=%.2f change_to=%d", profile.changeAtS, profile.changeTo);
+	printf("\n");
+
+	Candidate baseline = Candidate();
+	baseline.kp = BASELINE_KP;
+	baseline.ki = BASELINE_KI;
+	baseline.kd = BASELINE_KD;
+	run_candidate(baseline, model, profile, metrics, initial, overshootWeight, chatterWeight);
+	print_candidate("baseline", 0, baseline);
+#if PID_GAIN_SCHEDULE
+	Candidate scheduled = Candidate();
+	run_candidate(scheduled, model, profile, metrics, initial, overshootWeight, chatterWeight, 0, true);
+	print_candidate("scheduled", 0, scheduled);
+#endif
+
+	for (int r = 0; r < top && r < (int)candidates.size(); ++r)
+		print_candidate("best", r + 1, candidates[r]);
+
+	if (tracePath && !candidates.empty())
+	{
+		FILE *trace = fopen(tracePath, "w");
+		if (!trace)
+		{
+			perror(tracePath);
+			return 1;
+		}
+		fprintf(trace, "# t_ms true_rpm measured_rpm output\n");
+		run_candidate(candidates[0], model, profile, metrics, initial, overshootWeight, chatterWeight, trace);
+		fclose(trace);
+	}
+	return 0;
+}
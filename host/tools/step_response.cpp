@@ -0,0 +1,116 @@
+/*
+ * step_response.cpp
+ *
+ * Created: 10/17/2026 11:48:20 PM
+ *  Author: Bibek Shrestha
+ */
+
+
+#include <stdlib.h>
+
+#include "step_response.h"
+
+
+StepResponse::StepResponse(const StepConfig &config)
+	: config_(config), haveTarget_(false), target_(0), active_(false),
+	  lastMs_(0), t10_(-1), t90_(-1), maxOver_(0), band_(0),
+	  errors_(config.window > 0 ? config.window : 1, 0), errorCount_(0), errorSum_(0)
+{
+}
+
+void StepResponse::begin(double timeMs, int from, int to, int rpm)
+{
+	int span = abs(to - rpm);
+
+	step_ = StepResult();
+	step_.startMs  = timeMs;
+	step_.from     = from;
+	step_.to       = to;
+	step_.startRpm = rpm;
+	step_.settleMs = -1;
+
+	t10_ = t90_ = -1;
+	maxOver_ = 0;
+	band_ = (int)(span * config_.bandPct / 100.0);
+	if (band_ < config_.bandMin)
+		band_ = config_.bandMin;
+	errorCount_ = 0;
+	errorSum_ = 0;
+	active_ = true;
+}
+
+bool StepResponse::add(double timeMs, bool running, int rpm, int setpoint, StepResult &done)
+{
+	int target = running ? setpoint : 0;
+	bool ended = false;
+
+	if (!haveTarget_)
+	{
+		haveTarget_ = true;
+		target_ = target;
+	}
+	else if (target != target_)
+	{
+		ended = finish(done);
+		if (running && abs(target - target_) >= config_.minStep)
+			begin(timeMs, target_, target, rpm);
+		target_ = target;
+	}
+
+	if (!active_)
+		return ended;
+
+	StepResult &s = step_;
+	int span = s.to - s.startRpm;
+	int direction = span < 0 ? -1 : 1;
+	int progress = (rpm - s.startRpm) * direction;
+	int distance = abs(span);
+
+	/* crossing times, without division */
+	if (t10_ < 0 && 10 * progress >= distance)
+		t10_ = timeMs;
+	if (t90_ < 0 && 10 * progress >= 9 * distance)
+		t90_ = timeMs;
+
+	int over = (rpm - s.to) * direction;
+	if (over > maxOver_)
+		maxOver_ = over;
+
+	if (abs(rpm - s.to) > band_)
+		s.settleMs = -1;
+	else if (s.settleMs < 0)
+		s.settleMs = timeMs - s.startMs;
+
+	int error = s.to - rpm;
+	int slot = s.samples % errors_.size();
+	if (errorCount_ == (int)errors_.size())
+		errorSum_ -= errors_[slot];
+	else
+		++errorCount_;
+	errors_[slot] = error;
+	errorSum_ += error;
+
+	++s.samples;
+	lastMs_ = timeMs;
+	return ended;
+}
+
+bool StepResponse::finish(StepResult &done)
+{
+	if (!active_)
+		return false;
+	active_ = false;
+
+	StepResult &s = step_;
+	int distance = abs(s.to - s.startRpm);
+
+	s.risen        = t10_ >= 0 && t90_ >= 0;
+	s.riseMs       = s.risen ? t90_ - t10_ : -1;
+	s.overshootPct = distance ? 100.0 * maxOver_ / distance : 0;
+	s.settled      = s.settleMs >= 0;
+	s.sse          = errorCount_ ? (double)errorSum_ / errorCount_ : 0;
+	s.durationMs   = lastMs_ - s.startMs;
+
+	done = s;
+	return s.samples > 0;
+}
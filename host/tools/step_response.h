@@ -0,0 +1,83 @@
+/*
+ * step_response.h
+ *
+ * Created: 10/17/2026 11:48:20 PM
+ *  Author: Bibek Shrestha
+ *
+ * Step response of one motor, measured on the fly from its telemetry
+ * samples. A step starts whenever the target changes by at least
+ * minStep: the setpoint while the motor runs, 0 while it is stopped.
+ * It ends at the next target change or the end of the stream. Steps
+ * down to 0 (stops) are not measured; the motor coasts then.
+ *
+ *   rise      10% to 90% of the way from the RPM at the step to the target
+ *   overshoot furthest excursion past the target, % of the step
+ *   settle    time from the step until RPM entered the band around the
+ *             target for good (band = bandPct of the step, at least bandMin)
+ *   sse       mean target - RPM over the last window samples of the step
+ *
+ * Each motor needs O(window) memory whatever the log length.
+ */
+
+
+#ifndef STEP_RESPONSE_H_
+#define STEP_RESPONSE_H_
+
+#include <stdint.h>
+#include <vector>
+
+struct StepConfig
+{
+	int    minStep;				/* RPM */
+	double bandPct;
+	int    bandMin;				/* RPM */
+	int    window;				/* samples */
+
+	StepConfig() : minStep(50), bandPct(2.0), bandMin(10), window(20) {}
+};
+
+struct StepResult
+{
+	double   startMs;
+	int      from, to;			/* targets */
+	int      startRpm;
+	bool     risen;
+	double   riseMs;
+	double   overshootPct;
+	bool     settled;
+	double   settleMs;
+	double   sse;				/* RPM */
+	double   durationMs;
+	uint32_t samples;
+};
+
+class StepResponse
+{
+public:
+	explicit StepResponse(const StepConfig &config = StepConfig());
+
+	/* true when this sample ended a step; its result is in done */
+	bool add(double timeMs, bool running, int rpm, int setpoint, StepResult &done);
+
+	/* ends the step in progress, at the end of the stream */
+	bool finish(StepResult &done);
+
+private:
+	void begin(double timeMs, int from, int to, int rpm);
+
+	StepConfig config_;
+	bool   haveTarget_;
+	int    target_;
+	bool   active_;
+	StepResult step_;
+	double lastMs_;
+	double t10_, t90_;
+	int    maxOver_;
+	int    band_;
+
+	std::vector<int> errors_;	/* ring of the last window errors */
+	int    errorCount_;
+	long   errorSum_;
+};
+
+#endif /* STEP_RESPONSE_H_ */
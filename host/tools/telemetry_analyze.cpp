@@ -0,0 +1,359 @@
+/*
+ * telemetry_analyze.cpp
+ *
+ * Created: 10/17/2026 11:48:20 PM
+ *  Author: Bibek Shrestha
+ *
+ * Reads uart0 telemetry from a serial port, pty, recorded file or stdin
+ * ("-") as it arrives and prints, one "key=value" line each:
+ *
+ *   step     every setpoint change of the back and front motors: rise
+ *            time, overshoot, settling time and steady-state error
+ *            (step_response.h)
+ *   capture  every throw capture (trace.h): per motor the RPM before
+ *            the trigger, the lowest RPM after it and the time to get
+ *            back within the band
+ *   ff       feed-forward points captured with 'f' on uart3, as sent
+ *   summary  at the end of the input or on Ctrl-C: byte/record counts,
+ *            bad frames and records the firmware dropped
+ *
+ * With -r every decoded record is printed as well. A tty is switched to
+ * raw mode at -b baud (57600). Memory use does not grow with the input.
+ *
+ *   telemetry_analyze [-b baud] [-p ascii_period_ms] [-m min_step]
+ *                     [-B band_pct] [-w sse_window] [-r] device|file|-
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "telemetry_stream.h"
+#include "step_response.h"
+#include "trace.h"
+
+static volatile sig_atomic_t interrupted;
+
+static const char *const motor_names[MOTOR_COUNT] = { "back", "front", "side" };
+
+
+static void on_interrupt(int)
+{
+	interrupted = 1;
+}
+
+static speed_t baud_constant(long baud)
+{
+	switch (baud)
+	{
+	case 9600:		return B9600;
+	case 19200:		return B19200;
+	case 38400:		return B38400;
+	case 57600:		return B57600;
+	case 115200:	return B115200;
+	case 230400:	return B230400;
+	}
+	return 0;
+}
+
+static int open_input(const char *path, long baud)
+{
+	if (!strcmp(path, "-"))
+		return STDIN_FILENO;
+
+	int fd = open(path, O_RDONLY | O_NOCTTY);
+	if (fd < 0)
+	{
+		fprintf(stderr, "telemetry_analyze: %s: %s\n", path, strerror(errno));
+		return -1;
+	}
+	if (isatty(fd))
+	{
+		struct termios tio;
+		speed_t speed = baud_constant(baud);
+
+		if (!speed || tcgetattr(fd, &tio))
+		{
+			fprintf(stderr, "telemetry_analyze: %s: cannot set %ld baud\n", path, baud);
+			close(fd);
+			return -1;
+		}
+		cfmakeraw(&tio);
+		cfsetispeed(&tio, speed);
+		cfsetospeed(&tio, speed);
+		tio.c_cc[VMIN]  = 1;
+		tio.c_cc[VTIME] = 0;
+		tcsetattr(fd, TCSANOW, &tio);
+	}
+	return fd;
+}
+
+static const char *reason_name(uint8_t reason)
+{
+	switch (reason)
+	{
+	case TRACE_TRIGGER_HOME:	return "home";
+	case TRACE_TRIGGER_UP:		return "up";
+	case TRACE_TRIGGER_COMMAND:	return "command";
+	}
+	return "unknown";
+}
+
+
+/* one throw capture; at most 255 samples, so it is kept whole */
+struct Capture
+{
+	bool    open;
+	uint8_t number, reason, count, trigger;
+	uint16_t triggerTicks;
+	int     received;
+	int     rpm[MOTOR_SIDE][256];
+	int16_t offset[256];		/* ms from the trigger sample */
+};
+
+
+class Analyzer : public TelemetrySink
+{
+public:
+	Analyzer(const StepConfig &config, bool raw)
+		: captures(0), config_(config), raw_(raw)
+	{
+		for (int m = 0; m < MOTOR_SIDE; ++m)
+		{
+			motor_[m] = StepResponse(config);
+			steps[m] = 0;
+		}
+		capture_.open = false;
+	}
+
+	void record(const TelemetryRecord &r)
+	{
+		if (raw_)
+			print_record(r);
+
+		switch (r.kind)
+		{
+		case TelemetryRecord::SAMPLE:
+			for (int m = 0; m < MOTOR_SIDE; ++m)
+			{
+				StepResult done;
+				if (motor_[m].add(r.timeMs, r.running, r.rpm[m], r.setpoint[m], done))
+					print_step(m, done);
+			}
+			break;
+
+		case TelemetryRecord::TRACE_HEAD:
+			end_capture();
+			capture_.open         = true;
+			capture_.number       = r.capture;
+			capture_.reason       = r.reason;
+			capture_.count        = r.count;
+			capture_.trigger      = r.trigger;
+			capture_.triggerTicks = r.ticks;
+			capture_.received     = 0;
+			break;
+
+		case TelemetryRecord::TRACE_SAMPLE:
+			if (capture_.open && r.sequence == capture_.received)
+			{
+				int i = capture_.received++;
+				for (int m = 0; m < MOTOR_SIDE; ++m)
+					capture_.rpm[m][i] = r.rpm[m];
+				capture_.offset[i] = (int16_t)(r.ticks - capture_.triggerTicks);
+				if (capture_.received == capture_.count)
+					end_capture();
+			}
+			break;
+		}
+	}
+
+	void text(const char *line)
+	{
+		if (!strncmp(line, "ff ", 3))
+			printf("%s\n", line);
+	}
+
+	void finish(void)
+	{
+		for (int m = 0; m < MOTOR_SIDE; ++m)
+		{
+			StepResult done;
+			if (motor_[m].finish(done))
+				print_step(m, done);
+		}
+		end_capture();
+	}
+
+	uint64_t steps[MOTOR_SIDE];
+	uint64_t captures;
+
+private:
+	void print_record(const TelemetryRecord &r)
+	{
+		if (r.kind == TelemetryRecord::TRACE_HEAD)
+		{
+			printf("record kind=capture_head capture=%u reason=%s ticks=%u count=%u trigger=%u\n",
+				   r.capture, reason_name(r.reason), r.ticks, r.count, r.trigger);
+			return;
+		}
+		printf("record kind=%s t_ms=%.0f running=%d position=%u",
+			   r.kind == TelemetryRecord::SAMPLE ? (r.binary ? "sample" : "ascii") : "capture",
+			   r.kind == TelemetryRecord::SAMPLE ? r.timeMs : (double)r.ticks,
+			   r.running, r.position);
+		for (int m = 0; m < (r.hasSide ? MOTOR_COUNT : MOTOR_SIDE); ++m)
+			printf(" %s=%d/%d/%d", motor_names[m], r.rpm[m], r.setpoint[m], r.ocr[m]);
+		if (r.load >= 0)
+			printf(" load=%d", r.load);
+		printf("\n");
+	}
+
+	void print_step(int motor, const StepResult &s)
+	{
+		++steps[motor];
+		printf("step motor=%s t_ms=%.0f from=%d to=%d start_rpm=%d",
+			   motor_names[motor], s.startMs, s.from, s.to, s.startRpm);
+		if (s.risen)
+			printf(" rise_ms=%.0f", s.riseMs);
+		else
+			printf(" rise_ms=-");
+		printf(" overshoot_pct=%.1f", s.overshootPct);
+		if (s.settled)
+			printf(" settle_ms=%.0f", s.settleMs);
+		else
+			printf(" settle_ms=-");
+		printf(" sse=%.1f duration_ms=%.0f samples=%u\n", s.sse, s.durationMs, s.samples);
+	}
+
+	void end_capture(void)
+	{
+		Capture &c = capture_;
+
+		if (!c.open)
+			return;
+		c.open = false;
+		++captures;
+
+		printf("capture n=%u reason=%s samples=%d/%u pretrigger=%u",
+			   c.number, reason_name(c.reason), c.received, c.count, c.trigger);
+		if (c.received <= c.trigger)
+		{
+			printf(" incomplete\n");
+			return;
+		}
+		for (int m = 0; m < MOTOR_SIDE; ++m)
+		{
+			long base = 0;
+			for (int i = 0; i < c.trigger; ++i)
+				base += c.rpm[m][i];
+			base = c.trigger ? base / c.trigger : c.rpm[m][c.trigger];
+
+			int low = c.trigger;
+			for (int i = c.trigger; i < c.received; ++i)
+				if (c.rpm[m][i] < c.rpm[m][low])
+					low = i;
+
+			int band = (int)(base * config_.bandPct / 100.0);
+			if (band < config_.bandMin)
+				band = config_.bandMin;
+
+			int back = -1;
+			for (int i = low; i < c.received && back < 0; ++i)
+				if (abs(c.rpm[m][i] - (int)base) <= band)
+					back = i;
+
+			printf(" %s_base=%ld %s_min=%d %s_dip=%ld %s_min_ms=%d",
+				   motor_names[m], base, motor_names[m], c.rpm[m][low],
+				   motor_names[m], base - c.rpm[m][low], motor_names[m], c.offset[low]);
+			if (back >= 0)
+				printf(" %s_recover_ms=%d", motor_names[m], c.offset[back]);
+			else
+				printf(" %s_recover_ms=-", motor_names[m]);
+		}
+		printf("\n");
+	}
+
+	StepConfig   config_;
+	bool         raw_;
+	StepResponse motor_[MOTOR_SIDE];
+	Capture      capture_;
+};
+
+
+static void usage(void)
+{
+	fprintf(stderr,
+			"usage: telemetry_analyze [-b baud] [-p ascii_period_ms] [-m min_step]\n"
+			"                         [-B band_pct] [-w sse_window] [-r] device|file|-\n");
+}
+
+int main(int argc, char **argv)
+{
+	StepConfig config;
+	long baud = 57600;
+	double asciiPeriod = 10.0;
+	bool raw = false;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "b:p:m:B:w:r")) != -1)
+	{
+		switch (opt)
+		{
+		case 'b': baud = strtol(optarg, 0, 10); break;
+		case 'p': asciiPeriod = strtod(optarg, 0); break;
+		case 'm': config.minStep = atoi(optarg); break;
+		case 'B': config.bandPct = strtod(optarg, 0); break;
+		case 'w': config.window = atoi(optarg); break;
+		case 'r': raw = true; break;
+		default:  usage(); return 2;
+		}
+	}
+	if (optind != argc - 1 || config.window < 1)
+	{
+		usage();
+		return 2;
+	}
+
+	int fd = open_input(argv[optind], baud);
+	if (fd < 0)
+		return 1;
+
+	/* no SA_RESTART: Ctrl-C ends a blocking read and prints the summary */
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = on_interrupt;
+	sigaction(SIGINT, &action, 0);
+	sigaction(SIGTERM, &action, 0);
+
+	Analyzer analyzer(config, raw);
+	TelemetryStream stream(asciiPeriod);
+	uint8_t chunk[4096];
+
+	while (!interrupted)
+	{
+		ssize_t n = read(fd, chunk, sizeof(chunk));
+		if (n > 0)
+			stream.feed(chunk, (size_t)n, analyzer);
+		else if (n == 0 || errno != EINTR)
+			break;
+	}
+	analyzer.finish();
+
+	printf("summary bytes=%llu frames=%llu ascii=%llu text=%llu bad_frames=%llu lost=%llu"
+		   " steps_back=%llu steps_front=%llu captures=%llu\n",
+		   (unsigned long long)stream.bytes, (unsigned long long)stream.frames,
+		   (unsigned long long)stream.lines, (unsigned long long)stream.textLines,
+		   (unsigned long long)stream.badFrames, (unsigned long long)stream.lost,
+		   (unsigned long long)analyzer.steps[MOTOR_BACK],
+		   (unsigned long long)analyzer.steps[MOTOR_FRONT],
+		   (unsigned long long)analyzer.captures);
+
+	if (fd != STDIN_FILENO)
+		close(fd);
+	return 0;
+}
@@ -0,0 +1,277 @@
+/*
+ * telemetry_stream.cpp
+ *
+ * Created: 10/17/2026 11:48:20 PM
+ *  Author: Bibek Shrestha
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "telemetry_stream.h"
+#include "telemetry.h"
+
+/* COBS codes of our frames stay far below this, ASCII lines start above */
+#define FRAME_CODE_LIMIT	0x20
+
+
+static uint8_t crc8_update(uint8_t crc, uint8_t data)
+{
+	crc ^= data;
+	for (int i = 0; i < 8; ++i)
+		crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+	return crc;
+}
+
+/* returns the decoded length, or -1 */
+static int cobs_decode(const uint8_t *in, size_t len, uint8_t *out, size_t size)
+{
+	size_t i = 0, o = 0;
+
+	while (i < len)
+	{
+		uint8_t code = in[i++];
+		if (!code)
+			return -1;
+		for (uint8_t j = 1; j < code; ++j)
+		{
+			if (i >= len || o >= size)
+				return -1;
+			out[o++] = in[i++];
+		}
+		if (code < 0xFF && i < len)
+		{
+			if (o >= size)
+				return -1;
+			out[o++] = 0;
+		}
+	}
+	return (int)o;
+}
+
+static int unsigned12(const uint8_t *p, int field)
+{
+	return field ? (p[1] >> 4) | (p[2] << 4) : p[0] | ((p[1] & 0x0F) << 8);
+}
+
+static int signed12(const uint8_t *p, int field)
+{
+	int value = unsigned12(p, field);
+	return (value & 0x800) ? value - 0x1000 : value;
+}
+
+
+TelemetryStream::TelemetryStream(double asciiPeriodMs)
+	: bytes(0), frames(0), lines(0), textLines(0), badFrames(0), lost(0),
+	  length_(0), overflow_(false), afterLine_(false),
+	  asciiPeriodMs_(asciiPeriodMs), asciiTimeMs_(0),
+	  haveSequence_(false), sequence_(0),
+	  haveTicks_(false), ticks_(0), ticksHigh_(0)
+{
+}
+
+void TelemetryStream::feed(const uint8_t *data, size_t len, TelemetrySink &sink)
+{
+	bytes += len;
+
+	for (size_t i = 0; i < len; ++i)
+	{
+		uint8_t c = data[i];
+
+		if (c == 0x00)
+		{
+			end_frame(sink);
+			continue;
+		}
+		/* the '\r' of "\n\r"; 0x0D may also be the COBS code of a frame */
+		if (!length_ && c == '\r' && afterLine_)
+		{
+			afterLine_ = false;
+			continue;
+		}
+		afterLine_ = false;
+		/* inside a frame '\n' is just data */
+		if (c == '\n' && length_ && buffer_[0] >= FRAME_CODE_LIMIT)
+		{
+			end_line(sink);
+			continue;
+		}
+
+		if (length_ < BUFFER_SIZE)
+			buffer_[length_++] = c;
+		else
+			overflow_ = true;
+	}
+}
+
+void TelemetryStream::end_frame(TelemetrySink &sink)
+{
+	TelemetryRecord record;
+
+	if (length_)
+	{
+		if (!overflow_ && buffer_[0] < FRAME_CODE_LIMIT && decode_frame(record))
+		{
+			++frames;
+			sink.record(record);
+		}
+		else
+		{
+			++badFrames;
+		}
+	}
+	length_ = 0;
+	overflow_ = false;
+	afterLine_ = false;
+}
+
+void TelemetryStream::end_line(TelemetrySink &sink)
+{
+	TelemetryRecord record;
+
+	if (!overflow_ && parse_line(record))
+	{
+		++lines;
+		sink.record(record);
+	}
+	else
+	{
+		++textLines;
+		if (!overflow_)
+		{
+			char line[BUFFER_SIZE + 1];
+			size_t len = length_;
+			while (len && (buffer_[len - 1] == '\r' || buffer_[len - 1] == '\n'))
+				--len;
+			memcpy(line, buffer_, len);
+			line[len] = '\0';
+			sink.text(line);
+		}
+	}
+	length_ = 0;
+	overflow_ = false;
+	afterLine_ = true;
+}
+
+
+bool TelemetryStream::decode_frame(TelemetryRecord &record)
+{
+	uint8_t r[BUFFER_SIZE];
+	int len = cobs_decode(buffer_, length_, r, sizeof(r));
+
+	if (len < 2)
+		return false;
+
+	uint8_t crc = 0;
+	for (int i = 0; i < len - 1; ++i)
+		crc = crc8_update(crc, r[i]);
+	if (crc != r[len - 1])
+		return false;
+
+	memset(&record, 0, sizeof(record));
+	record.binary = true;
+	record.load = -1;
+
+	switch (r[0] >> 5)
+	{
+	case TELEMETRY_RECORD_SAMPLE:
+		if (len != TELEMETRY_PAYLOAD_SIZE + 1)
+			return false;
+		record.kind     = TelemetryRecord::SAMPLE;
+		record.running  = (r[0] & 0x10) != 0;
+		record.position = r[0] & 0x0F;
+		record.sequence = r[1];
+		record.ticks    = r[2] | (r[3] << 8);
+		record.rpm[MOTOR_BACK]       = unsigned12(r + 4, 0);
+		record.setpoint[MOTOR_BACK]  = unsigned12(r + 4, 1);
+		record.ocr[MOTOR_BACK]       = signed12(r + 7, 0);
+		record.rpm[MOTOR_FRONT]      = unsigned12(r + 7, 1);
+		record.setpoint[MOTOR_FRONT] = unsigned12(r + 10, 0);
+		record.ocr[MOTOR_FRONT]      = signed12(r + 10, 1);
+		record.rpm[MOTOR_SIDE]       = unsigned12(r + 13, 0);
+		record.ocr[MOTOR_SIDE]       = signed12(r + 13, 1);
+		record.hasSide  = true;
+		record.load     = r[16];
+
+		if (haveSequence_)
+			lost += (uint8_t)(record.sequence - sequence_ - 1);
+		haveSequence_ = true;
+		sequence_ = record.sequence;
+
+		/* gaps over 65 s between records would be missed */
+		if (haveTicks_ && record.ticks < ticks_)
+			ticksHigh_ += 0x10000;
+		haveTicks_ = true;
+		ticks_ = record.ticks;
+		record.timeMs = (double)(ticksHigh_ + record.ticks);
+		return true;
+
+	case TELEMETRY_RECORD_TRACE:
+		if (len != TELEMETRY_TRACE_PAYLOAD + 1)
+			return false;
+		record.kind          = TelemetryRecord::TRACE_SAMPLE;
+		record.running       = true;
+		record.triggerSample = (r[0] & 0x10) != 0;
+		record.position      = r[0] & 0x0F;
+		record.sequence      = r[1];
+		record.ticks         = r[2] | (r[3] << 8);
+		record.rpm[MOTOR_BACK]       = unsigned12(r + 4, 0);
+		record.setpoint[MOTOR_BACK]  = unsigned12(r + 4, 1);
+		record.ocr[MOTOR_BACK]       = signed12(r + 7, 0);
+		record.rpm[MOTOR_FRONT]      = unsigned12(r + 7, 1);
+		record.setpoint[MOTOR_FRONT] = unsigned12(r + 10, 0);
+		record.ocr[MOTOR_FRONT]      = signed12(r + 10, 1);
+		return true;
+
+	case TELEMETRY_RECORD_TRACE_HEAD:
+		if (len != TELEMETRY_TRACE_HEAD_PAYLOAD + 1)
+			return false;
+		record.kind    = TelemetryRecord::TRACE_HEAD;
+		record.reason  = r[0] & 0x1F;
+		record.capture = r[1];
+		record.ticks   = r[2] | (r[3] << 8);
+		record.count   = r[4];
+		record.trigger = r[5];
+		return true;
+	}
+	return false;
+}
+
+/* "1 RPM setpoint Ocr RPM setpoint Ocr", back motor first */
+bool TelemetryStream::parse_line(TelemetryRecord &record)
+{
+	char line[BUFFER_SIZE + 1];
+	long value[7];
+	char *p = line;
+
+	memcpy(line, buffer_, length_);
+	line[length_] = '\0';
+
+	for (int i = 0; i < 7; ++i)
+	{
+		char *end;
+		value[i] = strtol(p, &end, 10);
+		if (end == p)
+			return false;
+		p = end;
+	}
+	while (*p == ' ' || *p == '\r')
+		++p;
+	if (*p || (value[0] != 1 && value[0] != 2))
+		return false;
+
+	memset(&record, 0, sizeof(record));
+	record.kind    = TelemetryRecord::SAMPLE;
+	record.running = value[0] == 2;
+	record.load    = -1;
+	record.rpm[MOTOR_BACK]       = (int)value[1];
+	record.setpoint[MOTOR_BACK]  = (int)value[2];
+	record.ocr[MOTOR_BACK]       = (int)value[3];
+	record.rpm[MOTOR_FRONT]      = (int)value[4];
+	record.setpoint[MOTOR_FRONT] = (int)value[5];
+	record.ocr[MOTOR_FRONT]      = (int)value[6];
+	record.timeMs = asciiTimeMs_;
+	asciiTimeMs_ += asciiPeriodMs_;
+	return true;
+}
@@ -0,0 +1,103 @@
+/*
+ * telemetry_stream.h
+ *
+ * Created: 10/17/2026 11:48:20 PM
+ *  Author: Bibek Shrestha
+ *
+ * Incremental decoder for what the firmware sends on uart0: the ASCII
+ * "1 RPM setpoint Ocr RPM setpoint Ocr\n\r" lines of TELEMETRY_BINARY 0
+ * builds and the COBS framed records of telemetry.h (live samples and
+ * throw captures), in any mix. Bytes go in as they arrive, in chunks of
+ * any size; only the record being received is buffered.
+ *
+ * A frame starts with its COBS code (below 0x20), a line with '1' or '2',
+ * which is how the two are told apart. Other text (the latency dump,
+ * feed-forward points) is counted and handed to TelemetrySink::text();
+ * frames with a bad CRC or length are counted and dropped.
+ */
+
+
+#ifndef TELEMETRY_STREAM_H_
+#define TELEMETRY_STREAM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum TelemetryMotor
+{
+	MOTOR_BACK,
+	MOTOR_FRONT,
+	MOTOR_SIDE,
+	MOTOR_COUNT
+};
+
+struct TelemetryRecord
+{
+	enum Kind { SAMPLE, TRACE_HEAD, TRACE_SAMPLE } kind;
+
+	bool     binary;
+	bool     running;
+	uint8_t  position;
+	uint8_t  sequence;			/* binary samples: sequence; trace: sample index */
+	uint16_t ticks;				/* binary timestamp as sent, 1 ms */
+	double   timeMs;			/* samples: unwrapped, or line count * period for ASCII */
+
+	int      rpm[MOTOR_COUNT];
+	int      setpoint[MOTOR_COUNT];		/* side: none, 0 */
+	int      ocr[MOTOR_COUNT];
+	bool     hasSide;
+	int      load;				/* percent, -1 if not sent */
+
+	/* TRACE_HEAD */
+	uint8_t  reason, capture, count, trigger;
+	/* TRACE_SAMPLE */
+	bool     triggerSample;
+};
+
+class TelemetrySink
+{
+public:
+	virtual ~TelemetrySink() {}
+	virtual void record(const TelemetryRecord &record) = 0;
+	/* a line that is not a sample, without its line end */
+	virtual void text(const char *line) { (void)line; }
+};
+
+class TelemetryStream
+{
+public:
+	/* asciiPeriodMs: time between ASCII lines, which carry no timestamp */
+	explicit TelemetryStream(double asciiPeriodMs = 10.0);
+
+	void feed(const uint8_t *data, size_t len, TelemetrySink &sink);
+
+	uint64_t bytes;
+	uint64_t frames;			/* binary records decoded */
+	uint64_t lines;				/* ASCII samples decoded */
+	uint64_t textLines;			/* other text, skipped */
+	uint64_t badFrames;			/* CRC, length or COBS errors */
+	uint64_t lost;				/* sequence gaps: records dropped by the firmware */
+
+private:
+	enum { BUFFER_SIZE = 64 };
+
+	void end_frame(TelemetrySink &sink);
+	void end_line(TelemetrySink &sink);
+	bool decode_frame(TelemetryRecord &record);
+	bool parse_line(TelemetryRecord &record);
+
+	uint8_t  buffer_[BUFFER_SIZE];
+	size_t   length_;
+	bool     overflow_;
+	bool     afterLine_;
+
+	double   asciiPeriodMs_;
+	double   asciiTimeMs_;
+	bool     haveSequence_;
+	uint8_t  sequence_;
+	bool     haveTicks_;
+	uint16_t ticks_;
+	uint64_t ticksHigh_;
+};
+
+#endif /* TELEMETRY_STREAM_H_ */
@@ -0,0 +1,150 @@
+/*
+ * latency.cpp
+ *
+ * Created: 10/17/2026 8:05:47 PM
+ *  Author: Bibek Shrestha
+ */
+
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include <string.h>
+
+#include "latency.h"
+#include "uart.h"
+#include "format.h"
+
+#if LATENCY_STATS
+
+LatencyStat lat_stats[LAT_SOURCES];
+
+static uint8_t lat_dump_src = LAT_SOURCES;
+
+/* longest line: "lat " + 11 name + n, min/mean/max, 10 bins, "\r\n" = 127 */
+#define LAT_LINE_SIZE		128
+
+/* the line being sent; longer than the uart0 ring, so it may take steps */
+static char lat_line[LAT_LINE_SIZE];
+static uint8_t lat_line_len;
+static uint8_t lat_line_sent;
+
+static const char lat_names[LAT_TASK0][12] PROGMEM =
+{
+	"back_edge",
+	"back_ovf",
+	"front_edge",
+	"front_ovf",
+	"side_edge",
+	"side_ovf",
+	"pid_timer",
+	"en_front",
+	"en_back",
+	"en_b4x",
+	"uart0_rx",
+	"uart0_udre",
+	"uart1_rx",
+	"uart1_udre",
+	"uart2_rx",
+	"uart2_udre",
+	"uart3_rx",
+	"uart3_udre",
+	"sched_tick",
+	"lcd_flush",
+	"loop",
+	"stop",
+};
+
+/* counts as microseconds with one decimal */
+static void lat_put_us(FmtBuffer &out, uint16_t counts)
+{
+	fmt_u16(out, counts / LAT_COUNTS_PER_US);
+	out.put('.');
+	out.put('0' + (counts % LAT_COUNTS_PER_US) * 10 / LAT_COUNTS_PER_US);
+}
+
+
+void lat_clear(void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		memset(lat_stats, 0, sizeof(lat_stats));
+	}
+}
+
+void lat_dump_begin(void)
+{
+	lat_dump_src = 0;
+	lat_line_len = 0;
+	lat_line_sent = 0;
+}
+
+/* the next source with samples as one line in lat_line; 0 once done */
+static uint8_t lat_format_next(void)
+{
+	LatencyStat s;
+
+	do
+	{
+		if (lat_dump_src >= LAT_SOURCES)
+			return 0;
+		/* the ISR sources change under us */
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			s = lat_stats[lat_dump_src];
+		}
+		++lat_dump_src;
+	} while (!s.count);
+
+	uint8_t src = lat_dump_src - 1;
+	FmtBuffer out(lat_line);
+
+	fmt_str_P(out, PSTR("lat "));
+	if (src < LAT_TASK0)
+	{
+		fmt_str_P(out, lat_names[src]);
+	}
+	else
+	{
+		fmt_str_P(out, PSTR("task"));
+		out.put('0' + src - LAT_TASK0);
+	}
+	fmt_str_P(out, PSTR(" n="));
+	fmt_u16(out, s.count);
+	fmt_str_P(out, PSTR(" min="));
+	lat_put_us(out, s.min);
+	fmt_str_P(out, PSTR(" mean="));
+	lat_put_us(out, s.sum / s.count);
+	fmt_str_P(out, PSTR(" max="));
+	lat_put_us(out, s.max);
+	fmt_str_P(out, PSTR(" hist="));
+	for (uint8_t i = 0; i < LAT_BINS; ++i)
+	{
+		if (i)
+			out.put(',');
+		fmt_u16(out, s.hist[i]);
+	}
+	out.put('\r');
+	out.put('\n');
+
+	lat_line_len = out.p - lat_line;
+	lat_line_sent = 0;
+	return 1;
+}
+
+uint8_t lat_dump_step(void)
+{
+	if (lat_line_sent == lat_line_len && !lat_format_next())
+		return 0;
+
+	/* only what fits, so the line is never cut short (or counted dropped) */
+	uint8_t n = lat_line_len - lat_line_sent;
+	uint8_t room = uart0_tx_free();
+
+	if (n > room)
+		n = room;
+	lat_line_sent += uart0_try_write((const uint8_t *)lat_line + lat_line_sent, n);
+	return 1;
+}
+
+#endif
@@ -0,0 +1,145 @@
+/*
+ * latency.h
+ *
+ * Created: 10/17/2026 8:05:47 PM
+ *  Author: Bibek Shrestha
+ *
+ * Run time of every ISR and of the main loop, and the start lateness of
+ * every scheduler task, as min/mean/max and a coarse histogram per source.
+ * Timestamps come from the free-running Timer5 count (0.5 us, scheduler.h),
+ * so one span can be up to 32 ms long. The ISR prologue/epilogue are not
+ * inside the span.
+ *
+ * Off unless LATENCY_STATS is 1; the markers then compile to nothing. On,
+ * a marked ISR costs two timer reads and a lat_record() (about 60 cycles)
+ * and the table takes LAT_SOURCES * 30 bytes of RAM.
+ *
+ * Histogram bin 0 counts spans under 2 us, bin n spans under 2^(n+1) us,
+ * the last bin everything from 512 us up.
+ */
+
+
+#ifndef LATENCY_H_
+#define LATENCY_H_
+
+#include <stdint.h>
+#include <avr/io.h>
+#include <util/atomic.h>
+
+#include "scheduler.h"
+
+#ifndef LATENCY_STATS
+#define LATENCY_STATS		0
+#endif
+
+#define LAT_TCNT			SCHED_TCNT
+#define LAT_COUNTS_PER_US	SCHED_COUNTS_PER_US
+#define LAT_BINS			10
+#define LAT_BIN0_COUNTS		(2 * LAT_COUNTS_PER_US)
+
+enum LatencySource
+{
+	LAT_BACK_EDGE,			/* back motor INTn or input capture */
+	LAT_BACK_OVF,
+	LAT_FRONT_EDGE,
+	LAT_FRONT_OVF,
+	LAT_SIDE_EDGE,
+	LAT_SIDE_OVF,
+	LAT_PID_TIMER,
+	LAT_EN_FRONT,
+	LAT_EN_BACK,
+	LAT_EN_B4X,
+	LAT_UART0_RX,
+	LAT_UART0_UDRE,
+	LAT_UART1_RX,
+	LAT_UART1_UDRE,
+	LAT_UART2_RX,
+	LAT_UART2_UDRE,
+	LAT_UART3_RX,
+	LAT_UART3_UDRE,
+	LAT_SCHED_TICK,
+	LAT_LCD_FLUSH,
+	LAT_LOOP,				/* one sched_run() */
+	LAT_STOP,				/* stop byte on uart3 received -> motors stopped */
+	LAT_TASK0,				/* start lateness of scheduler task 0.. */
+	LAT_SOURCES = LAT_TASK0 + SCHED_MAX_TASKS
+};
+
+struct LatencyStat
+{
+	uint16_t min;			/* timer counts */
+	uint16_t max;
+	uint16_t count;
+	uint32_t sum;
+	uint16_t hist[LAT_BINS];
+};
+
+#if LATENCY_STATS
+
+extern LatencyStat lat_stats[LAT_SOURCES];
+
+/* safe from ISRs and from the main loop */
+static inline uint16_t lat_now(void)
+{
+	uint16_t t;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		t = LAT_TCNT;
+	}
+	return t;
+}
+
+/* each source must only be recorded from one context */
+static inline void lat_record(uint8_t src, uint16_t counts)
+{
+	LatencyStat &s = lat_stats[src];
+
+	if (!s.count || counts < s.min)
+		s.min = counts;
+	if (counts > s.max)
+		s.max = counts;
+
+	/* halve instead of wrapping, the mean and the bin shares stay right */
+	if (s.count == 0xFFFF)
+	{
+		s.count >>= 1;
+		s.sum >>= 1;
+		for (uint8_t i = 0; i < LAT_BINS; ++i)
+			s.hist[i] >>= 1;
+	}
+	++s.count;
+	s.sum += counts;
+
+	uint8_t bin = 0;
+	for (uint16_t edge = LAT_BIN0_COUNTS; bin < LAT_BINS - 1 && counts >= edge; edge <<= 1)
+		++bin;
+	++s.hist[bin];
+}
+
+void lat_clear(void);
+
+/*
+ * Dump over uart0, one text line per source that has samples:
+ *   lat <source> n=<count> min=<us> mean=<us> max=<us> hist=<b0>,...,<b9>
+ * lat_dump_begin() starts from the first source; every lat_dump_step()
+ * queues as much of the current line as the uart0 ring has room for,
+ * never waiting, and returns 0 once the table is done. A line is longer
+ * than the ring, so it goes out over a few steps; no step starts a second
+ * line.
+ */
+void lat_dump_begin(void);
+uint8_t lat_dump_step(void);
+
+#define LAT_BEGIN(src)			uint16_t lat_start_ = lat_now()
+#define LAT_END(src)			lat_record((src), lat_now() - lat_start_)
+#define LAT_RECORD(src, counts)	lat_record((src), (counts))
+
+#else
+
+#define LAT_BEGIN(src)
+#define LAT_END(src)
+#define LAT_RECORD(src, counts)
+
+#endif
+
+#endif /* LATENCY_H_ */
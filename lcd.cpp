@@ -6,49 +6,33 @@
  */
 
 #include "lcd.h" 
-static void lcd_write(uint8_t c)
+#include "latency.h"
+#include "format.h"
+#include <avr/interrupt.h>
+
+//put(char) targets for format.h
+struct LcdOut   { void put(char c) { lcd_putch(c); } };
+struct LcdFbOut { void put(char c) { lcd_fb_putch(c); } };
+
+//Put the low nibble of n on D7..D4 and strobe it in
+static void lcd_nibble(uint8_t n)
 {
-	_delay_us(40);
-	//MS nibble
-	if(c & 0x80)
+	if(n & 0x08)
 		LCD_D7_PORT |=  (1 << LCD_D7_PIN);
 	else
 		LCD_D7_PORT &= ~(1 << LCD_D7_PIN);
 	
-	if(c & 0x40)
+	if(n & 0x04)
 		LCD_D6_PORT |=  (1 << LCD_D6_PIN);
 	else
 		LCD_D6_PORT &= ~(1 << LCD_D6_PIN);
 	
-	if(c & 0x20)
+	if(n & 0x02)
 		LCD_D5_PORT |=  (1 << LCD_D5_PIN);
 	else
 		LCD_D5_PORT &= ~(1 << LCD_D5_PIN);
 		
-	if(c & 0x10)
-		LCD_D4_PORT |=  (1 << LCD_D4_PIN);
-	else
-		LCD_D4_PORT &= ~(1 << LCD_D4_PIN);
-	
-	LCD_STROBE();
-	
-	//LS nibble
-	if(c & 0x08)
-		LCD_D7_PORT |=  (1 << LCD_D7_PIN);
-	else
-		LCD_D7_PORT &= ~(1 << LCD_D7_PIN);
-		
-	if(c & 0x04)
-		LCD_D6_PORT |=  (1 << LCD_D6_PIN);
-	else
-		LCD_D6_PORT &= ~(1 << LCD_D6_PIN);
-		
-	if(c & 0x02)
-		LCD_D5_PORT |=  (1 << LCD_D5_PIN);
-	else
-		LCD_D5_PORT &= ~(1 << LCD_D5_PIN);
-		
-	if(c & 0x01)
+	if(n & 0x01)
 		LCD_D4_PORT |=  (1 << LCD_D4_PIN);
 	else
 		LCD_D4_PORT &= ~(1 << LCD_D4_PIN);
@@ -56,6 +40,13 @@ static void lcd_write(uint8_t c)
 	LCD_STROBE();
 }
 
+static void lcd_write(uint8_t c)
+{
+	_delay_us(40);
+	lcd_nibble(c >> 4);		//MS nibble
+	lcd_nibble(c);			//LS nibble
+}
+
 //Write command to LCD
 void lcd_cmd(uint8_t cmd)
 {
@@ -191,42 +182,29 @@ void lcd_unum_hex_wBlanking(uint16_t num)
 
 void lcd_unum3(uint8_t num)
 {
-	lcd_putch(num/100 + '0');
-	lcd_putch((num%100)/10 + '0');
-	lcd_putch(num%10 + '0');
+	LcdOut out;
+	fmt_u16(out, num, 3, '0');
 }
 
+//five cells, blank padded
 void lcd_unum(uint16_t num)
 {
-    uint16_t bcd = 0;
-    uint8_t bcd4 = 0;
-    for(uint8_t i=16; i!=0; --i)
-    {
-	    if((bcd&0x000F) >= 0x5)
-            bcd+=0x3;
-        if((bcd&0x00F0) >= 0x50)
-            bcd+=0x30;
-        if((bcd&0x0F00) >= 0x500)
-            bcd+=0x300;
-        if((bcd&0xF000) >= 0x5000)
-            bcd+=0x3000;
-            
-        bcd4 <<= 1;
-        bcd4 += ((bcd&0x8000)?1:0);
-        bcd <<= 1;
-        bcd += ((num&(1<<(i-1)))?1:0);
-    }
-	
-    lcd_putch((bcd4)?(chex[bcd4]):' ');    
-    lcd_putch((!bcd4 && bcd<0x1000)	?' ':(pgm_read_byte(&chex[bcd>>12])));
-    lcd_putch((!bcd4 && bcd<0x100)	?' ':(pgm_read_byte(&chex[(bcd>>8)&0x000F])));
-    lcd_putch((!bcd4 && bcd<0x10)	?' ':(pgm_read_byte(&chex[(bcd>>4)&0x000F])));
-    lcd_putch(pgm_read_byte(&chex[bcd&0x000F]));	
-}	
+	LcdOut out;
+	fmt_u16(out, num, 5);
+}
 
 void lcd_num( int num, int radix )
 {
-	char str[6];
+	if(radix == 10)
+	{
+		LcdOut out;
+		fmt_i16(out, num);
+		return;
+	}
+
+	/* radix 2 (Printf %b) gives up to 16 digits + NUL; avr-libc only signs
+	   radix 10, so a negative number is its 16 bit pattern */
+	char str[17];
 	itoa( num, str, radix );
 	lcd_puts( str );
 }
@@ -302,6 +280,180 @@ void Printf( char *fmt,... )
 
 
 
+/*
+ * Framebuffer
+ *
+ * lcd_fb holds what the display should show, lcd_fb_shown what it shows.
+ * The flusher walks the cells from where it left off, sends the cursor
+ * address only when the LCD's own address counter is not already there,
+ * then the character, one nibble per tick. A tick is at least 50us apart
+ * from the next, which covers the HD44780's 37us per byte.
+ */
 
+#define LCD_FB_CELLS		(LCD_FB_ROWS * LCD_FB_COLS)
+#define LCD_FB_SCAN			8		/* cells examined per idle tick */
+#define LCD_FB_NO_ADDR		0xFF
 
+static char lcd_fb[LCD_FB_CELLS];
+static char lcd_fb_shown[LCD_FB_CELLS];
+static uint8_t lcd_fb_cursor;
 
+static uint8_t lcd_fb_scan;			/* next cell the flusher looks at */
+static uint8_t lcd_fb_clean;		/* consecutive cells found clean */
+static uint8_t lcd_fb_addr;			/* LCD address counter, or LCD_FB_NO_ADDR */
+static uint8_t lcd_fb_byte;			/* byte in flight */
+static uint8_t lcd_fb_state;
+
+enum
+{
+	LCD_FB_IDLE,
+	LCD_FB_ADDR_LOW,				/* address command high nibble sent */
+	LCD_FB_DATA_HIGH,				/* address done, data high nibble next */
+	LCD_FB_DATA_LOW					/* data high nibble sent */
+};
+
+static inline uint8_t lcd_fb_ddram(uint8_t cell)
+{
+	return (cell < LCD_FB_COLS) ? cell : (0x40 + cell - LCD_FB_COLS);
+}
+
+//(re)start the flusher; it must see every cell again before it stops
+static inline void lcd_fb_kick(void)
+{
+	lcd_fb_clean = 0;
+	LCD_FB_TIMSK |= _BV(LCD_FB_OCIE);
+}
+
+void lcd_fb_init(void)
+{
+	for(uint8_t i = 0; i < LCD_FB_CELLS; ++i)
+	{
+		lcd_fb[i] = ' ';
+		lcd_fb_shown[i] = ' ';		//lcd_init() cleared the display
+	}
+	lcd_fb_cursor = 0;
+	lcd_fb_scan = 0;
+	lcd_fb_clean = 0;
+	lcd_fb_addr = LCD_FB_NO_ADDR;
+	lcd_fb_state = LCD_FB_IDLE;
+	
+	LCD_FB_TCCRA = _BV(LCD_FB_CTC);		//CTC, OCnA/OCnB disconnected
+	LCD_FB_TCCRB = LCD_FB_CLOCK;
+	LCD_FB_OCR = LCD_FB_TICKS;
+}
+
+void lcd_fb_clear(void)
+{
+	for(uint8_t i = 0; i < LCD_FB_CELLS; ++i)
+		lcd_fb[i] = ' ';
+	lcd_fb_cursor = 0;
+	lcd_fb_kick();
+}
+
+void lcd_fb_gotoxy(uint8_t x, uint8_t y)
+{
+	lcd_fb_cursor = (y ? LCD_FB_COLS : 0) + x;
+	if(x >= LCD_FB_COLS)
+		lcd_fb_cursor = LCD_FB_CELLS;	//off screen, writes are dropped
+}
+
+void lcd_fb_putch(char c)
+{
+	//clip at the end of the row like the visible part of the display
+	if(lcd_fb_cursor == LCD_FB_COLS - 1 || lcd_fb_cursor == LCD_FB_CELLS - 1)
+	{
+		lcd_fb[lcd_fb_cursor] = c;
+		lcd_fb_cursor = LCD_FB_CELLS;
+	}
+	else if(lcd_fb_cursor < LCD_FB_CELLS)
+	{
+		lcd_fb[lcd_fb_cursor++] = c;
+	}
+	lcd_fb_kick();
+}
+
+void lcd_fb_puts(const char *s)
+{
+	while(*s)
+		lcd_fb_putch(*s++);
+}
+
+void lcd_fb_num(int num)
+{
+	LcdFbOut out;
+	fmt_i16(out, num);
+}
+
+void lcd_fb_unum(uint16_t num, uint8_t width)
+{
+	LcdFbOut out;
+	fmt_u16(out, num, width);
+}
+
+void lcd_fb_tick(void)
+{
+	switch(lcd_fb_state)
+	{
+		case LCD_FB_ADDR_LOW:
+			lcd_nibble(lcd_fb_addr | 0x80);
+			lcd_fb_state = LCD_FB_DATA_HIGH;
+			return;
+		
+		case LCD_FB_DATA_HIGH:
+			LCD_RS_PORT |= (1 << LCD_RS_PIN);
+			lcd_nibble(lcd_fb_byte >> 4);
+			lcd_fb_state = LCD_FB_DATA_LOW;
+			return;
+		
+		case LCD_FB_DATA_LOW:
+			lcd_nibble(lcd_fb_byte);
+			lcd_fb_shown[lcd_fb_scan] = lcd_fb_byte;
+			lcd_fb_addr = lcd_fb_ddram(lcd_fb_scan) + 1;		//LCD auto increments
+			lcd_fb_scan = (lcd_fb_scan + 1 == LCD_FB_CELLS) ? 0 : lcd_fb_scan + 1;
+			lcd_fb_state = LCD_FB_IDLE;
+			return;
+		
+		default:
+			break;
+	}
+	
+	//idle: look for the next cell that differs
+	for(uint8_t n = 0; n < LCD_FB_SCAN; ++n)
+	{
+		char c = lcd_fb[lcd_fb_scan];
+		if(c != lcd_fb_shown[lcd_fb_scan])
+		{
+			lcd_fb_clean = 0;
+			lcd_fb_byte = c;
+			if(lcd_fb_addr == lcd_fb_ddram(lcd_fb_scan))
+			{
+				LCD_RS_PORT |= (1 << LCD_RS_PIN);
+				lcd_nibble(c >> 4);
+				lcd_fb_state = LCD_FB_DATA_LOW;
+			}
+			else
+			{
+				lcd_fb_addr = lcd_fb_ddram(lcd_fb_scan);
+				LCD_RS_PORT &= ~(1 << LCD_RS_PIN);
+				lcd_nibble((lcd_fb_addr | 0x80) >> 4);
+				lcd_fb_state = LCD_FB_ADDR_LOW;
+			}
+			return;
+		}
+		lcd_fb_scan = (lcd_fb_scan + 1 == LCD_FB_CELLS) ? 0 : lcd_fb_scan + 1;
+		if(++lcd_fb_clean >= LCD_FB_CELLS)
+		{
+			//display matches the framebuffer, sleep until the next write
+			lcd_fb_clean = 0;
+			LCD_FB_TIMSK &= ~_BV(LCD_FB_OCIE);
+			return;
+		}
+	}
+}
+
+ISR(LCD_FB_COMPARE_vect)
+{
+	LAT_BEGIN(LAT_LCD_FLUSH);
+	lcd_fb_tick();
+	LAT_END(LAT_LCD_FLUSH);
+}
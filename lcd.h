@@ -39,6 +39,22 @@
 		Writes supplied byte to LCD with RS = 0 (command)
 	lcd_dat(uint8_t c);
 		Writes supplied byte to LCD with RS = 1 (data)
+
+	Framebuffer (never blocks):
+	lcd_fb_init();
+		Call once after lcd_init(). From then on only the lcd_fb_*
+		functions may be used, the blocking ones would race the flusher
+	lcd_fb_gotoxy(x, y) / lcd_fb_putch(c) / lcd_fb_puts(s) / lcd_fb_num(n)
+		Write into the 2x16 RAM copy of the display
+	lcd_fb_unum(n, width)
+		Unsigned number right aligned in width cells, blank padded
+	lcd_fb_clear();
+		Fills the framebuffer with spaces
+	The LCD_FB timer interrupt sends cells that differ from what the
+	display shows, one nibble per tick, and switches itself off once the
+	display matches the framebuffer. lcd_fb_init() puts the timer in CTC
+	mode with OC2A/OC2B (PB4/PH6) disconnected, so the timer is taken
+	whole and neither pin can drive a motor; board.h claims both.
  *************************************************************/
 
 #ifndef	LCD_H_
@@ -49,21 +65,42 @@
 #define F_CPU 16000000UL
 #endif
 
-//
-#define LCD_EN_PORT	PORTC
-#define LCD_EN_PIN	PINC7
-	
-#define	LCD_RS_PORT PORTA		//R/S line
-#define	LCD_RS_PIN	PINA4
+#include "pins.h"
 
-#define LCD_D7_PORT PORTG
-#define LCD_D7_PIN	PING1
-#define LCD_D6_PORT PORTD
-#define LCD_D6_PIN	PIND7
-#define LCD_D5_PORT PORTC
-#define LCD_D5_PIN	PINC1
-#define LCD_D4_PORT PORTC
-#define LCD_D4_PIN	PINC3
+//Lines as port,bit pairs; board.h checks them against the other pins
+#define LCD_EN		C,7
+#define LCD_RS		A,4			//R/S line
+#define LCD_D7		G,1
+#define LCD_D6		D,7
+#define LCD_D5		C,1
+#define LCD_D4		C,3
+
+#define LCD_EN_PORT	PIN_PORT(LCD_EN)
+#define LCD_EN_PIN	PIN_BIT(LCD_EN)
+	
+#define	LCD_RS_PORT PIN_PORT(LCD_RS)
+#define	LCD_RS_PIN	PIN_BIT(LCD_RS)
+
+#define LCD_D7_PORT PIN_PORT(LCD_D7)
+#define LCD_D7_PIN	PIN_BIT(LCD_D7)
+#define LCD_D6_PORT PIN_PORT(LCD_D6)
+#define LCD_D6_PIN	PIN_BIT(LCD_D6)
+#define LCD_D5_PORT PIN_PORT(LCD_D5)
+#define LCD_D5_PIN	PIN_BIT(LCD_D5)
+#define LCD_D4_PORT PIN_PORT(LCD_D4)
+#define LCD_D4_PIN	PIN_BIT(LCD_D4)
+
+//Timer that paces the framebuffer flusher, one nibble per compare match
+#define LCD_FB_TIMER_NUM	2							/* the registers below */
+#define LCD_FB_TCCRA		TCCR2A
+#define LCD_FB_TCCRB		TCCR2B
+#define LCD_FB_OCR			OCR2A
+#define LCD_FB_TIMSK		TIMSK2
+#define LCD_FB_OCIE			OCIE2A
+#define LCD_FB_CTC			WGM21
+#define LCD_FB_CLOCK		(_BV(CS21) | _BV(CS20))		/* clk/32 */
+#define LCD_FB_TICKS		24							/* 25 counts = 50us per nibble */
+#define LCD_FB_COMPARE_vect	TIMER2_COMPA_vect
 
 
 
@@ -161,4 +198,16 @@ void lcd_num(int num, int radix = 10);
 void lcd_gotoxy(unsigned char x, unsigned char y);
 void Printf(char *fmt,...);
 
+#define LCD_FB_ROWS		2
+#define LCD_FB_COLS		16
+
+void lcd_fb_init(void);
+void lcd_fb_clear(void);
+void lcd_fb_gotoxy(uint8_t x, uint8_t y);
+void lcd_fb_putch(char c);
+void lcd_fb_puts(const char *s);
+void lcd_fb_num(int num);
+void lcd_fb_unum(uint16_t num, uint8_t width);
+void lcd_fb_tick(void);
+
 #endif /*LCD_H_*/
\ No newline at end of file
@@ -17,19 +17,72 @@
 #include "MzMotorBack.h"
 #include "MzMotorFront.h"
 #include "MotorSide.h"
+#include "simmark.h"
+#include "telemetry.h"
+#include "scheduler.h"
+#include "capture.h"
+#include "rpmfilter.h"
+#include "quadrature.h"
+#include "latency.h"
+#include "board.h"
+#include "trace.h"
+#include "feedforward.h"
+#include "profile.h"
+#include "calib.h"
+#include "command.h"
 
 
 #include <util/delay.h>
-
-
-#define DD_MGZ_LIMIT	F,7
-#define DD_THR_LIMIT	B,2
+#include <util/atomic.h>
+
+
+//Task periods in scheduler ticks (1ms), highest priority first
+#define CONTROL_PERIOD		4
+#define COMMAND_PERIOD		1
+#define TELEMETRY_PERIOD	10		/* 20 byte frame = 3.5ms at 57600 */
+#define DISPLAY_PERIOD		100
+
+//stop, start and arm hold are acted on in USART3_RX_vect (SafetyCommand),
+//a stop in a command frame too; 0 leaves them to CommandTask and
+//ControlTask, up to 5 ticks later
+#ifndef CMD_ISR_SAFETY
+#define CMD_ISR_SAFETY		1
+#endif
+
+//With CMD_ISR_SAFETY the motors are also stopped from USART3_RX_vect, so
+//every drive update in the tasks runs with interrupts off and checks
+//StartFlag/ArmHold inside: a stop byte then lands wholly before the
+//update, which does nothing, or wholly after it, which wins. The cost is
+//an RPM edge delayed by up to one Operate() (INTn + TCNT mode reads one
+//period long and the next short; capture mode is unaffected).
+#if CMD_ISR_SAFETY
+#define DRIVE_BLOCK			ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#else
+#define DRIVE_BLOCK
+#endif
 
 
 MotorBack		BackMotor;
 MotorFront		FrontMotor;
 MotorSide		SideMotor;
 
+#if MOTORBACK_CAPTURE
+CaptureChannel	BackCapture;
+#endif
+#if MOTORFRONT_CAPTURE
+CaptureChannel	FrontCapture;
+#endif
+#if SIDEMOTOR_CAPTURE
+CaptureChannel	SideCapture;
+#endif
+
+//period counts smoothed per edge before Count (rpmfilter.h)
+static RpmFilter	BackFilter;
+static RpmFilter	FrontFilter;
+
+QuadDecoder		FrontQuad;
+QuadDecoder		BackQuad;
+
 
 
 
@@ -46,272 +99,675 @@ unsigned char Rx_Buffer = 0x00;
 		bool TempReturn1  = false;
 		bool TempReturn2  = false;
 volatile bool StartFlag  = false;
+volatile bool ArmHold    = false;
+
+#if LATENCY_STATS && !CMD_ISR_SAFETY
+static volatile uint16_t StopStamp;
+static volatile bool     StopTimed = false;
+#endif
 
 long int RPM;
 
+bool MotorA_Return = false;
+bool MotorB_Return = false;
+bool MotorS_Return = false;
+
 char gStatus;
 char gPostion;
 
 
-int main(void)
+static void SendTelemetry(bool running)
 {
-	
-	PULLUP_ON(DD_MGZ_LIMIT);
+	TelemetrySample sample;
+
+	sample.timestamp     = sched_ticks();
+	sample.running       = running;
+	sample.position      = ThrowMotor.Position;
+	sample.backRPM       = BackMotor.RPM;
+	sample.backSetpoint  = BackMotor.Controller.setpoint;
+	sample.backOcr       = BackMotor.Ocr;
+	sample.frontRPM      = FrontMotor.RPM;
+	sample.frontSetpoint = FrontMotor.Controller.setpoint;
+	sample.frontOcr      = FrontMotor.Ocr;
+	sample.sideRPM       = SideMotor.RPM;
+	sample.sideOcr       = SideMotor.OCR;
+	sample.load          = sched_load();
+
+	telemetry_send(sample);
+}
 
 
-	if(1)
+/* one capture sample per control period; while running, a throw arm
+   transition triggers */
+static void RecordTrace(void)
+{
+	static uint8_t lastPosition = NONPOSITION;
+	TraceSample sample;
+
+	sample.timestamp     = sched_ticks();
+	sample.position      = ThrowMotor.Position;
+	sample.backRPM       = BackMotor.RPM;
+	sample.backSetpoint  = BackMotor.Controller.setpoint;
+	sample.backOcr       = BackMotor.Ocr;
+	sample.frontRPM      = FrontMotor.RPM;
+	sample.frontSetpoint = FrontMotor.Controller.setpoint;
+	sample.frontOcr      = FrontMotor.Ocr;
+
+	if(StartFlag && sample.position != lastPosition)
 	{
-		char Count1;
-		MzMotorBack  PreBackMagazine;
-		MzMotorFront PreFrontMagazine;
-		PreFrontMagazine.Initialise();
-		PreBackMagazine.Initialise();
-		ThrowMotor.Initialise();
+		if(sample.position == HOMEPOSITION)
+			trace_trigger(TRACE_TRIGGER_HOME);
+		else if(sample.position == UPPOSITION)
+			trace_trigger(TRACE_TRIGGER_UP);
+	}
+	lastPosition = sample.position;
+	trace_record(sample);
+}
 
 
-		PreFrontMagazine.PreMoveD();
-		PreBackMagazine.PreMoveD();
-		ThrowMotor.Operate(1);
+/* a whole throw profile in one control tick */
+static void ApplyProfile(const ThrowProfile &profile)
+{
+	BackMotor.Controller.Set_Setpoint(profile.backRpm);
+	FrontMotor.Controller.Set_Setpoint(profile.frontRpm ? profile.frontRpm : profile.backRpm);
 
-		while(1)
+	if(profile.magazine == PROFILE_MAGAZINE_STOP)
+	{
+		DRIVE_BLOCK
 		{
-			if(!READ(DD_MGZ_LIMIT))
-			{
-				++Count1;
-			}
-			if(Count1)
+			MagazineBack.StopMotor();
+			MagazineFront.StopMotor();
+		}
+	}
+	else if(profile.magazine == PROFILE_MAGAZINE_LOAD && ThrowMotor.Position == HOMEPOSITION)
+	{
+		DRIVE_BLOCK
+		{
+			if(StartFlag)
 			{
-				PreBackMagazine.StopMotor();
-				PreFrontMagazine.StopMotor();
-				break;
+				TempReturn1 = MagazineFront.Operate(true);
+				TempReturn2 = MagazineBack.Operate(true);
 			}
-			ThrowMotor.Operate(0);
 		}
-		
 	}
+}
 
 
-	bool MotorA_Return = false;
-	bool MotorB_Return = false;
-	bool MotorS_Return = false;
-
-	
-	initialise();
-
-	BackMotor.Initialise();
-	FrontMotor.Initialise();
-	
-
-
-	
-
-	
-	MagazineFront.Initialise();
-	MagazineBack.Initialise();
-	SideMotor.Initialise();
-
+//all drives off; also from USART3_RX_vect
+static void StopMotors(void)
+{
 	BackMotor.StopMotor();
 	FrontMotor.StopMotor();
 	SideMotor.StopMotor();
+}
+
 
+static void ControlTask(void)
+{
+	SIM_BEGIN(SIM_SPAN_CONTROL);
 	
+	ThrowProfile profile;
+	if(profile_take(profile))
+		ApplyProfile(profile);
 
-	ThrowMotor.StopMotor();
+	gLimitFlag = ThrowMotor.LimitFlag;
+	gChangeFlag = ThrowMotor.ChangeFlag;
 
-	sei();
-	bluetooth_check();
-	
-	while(1)
+	gStatus = ThrowMotor.Status;
+	gPostion = ThrowMotor.Position; 
+
+	RPM = SideMotor.RPM;
+
+	if(StartFlag == true)
 	{
-	
-		
-		gLimitFlag = ThrowMotor.LimitFlag;
-		gChangeFlag = ThrowMotor.ChangeFlag;
-	
-		gStatus = ThrowMotor.Status;
-		gPostion = ThrowMotor.Position; 
+		DRIVE_BLOCK
+		{
+			if(StartFlag)
+			{
+				MotorA_Return = BackMotor.Operate(rx, Rx_Buffer);
+				FrontMotor.SetOcrValue(BackMotor.Ocr);
+			}
+		}
 
 		
+		DRIVE_BLOCK
+		{
+			if(StartFlag)
+				MotorS_Return = SideMotor.Operate(rx, Rx_Buffer, 0);
+		}
+
 
-		if(uart3_available())
-		{	
-			Rx_Buffer = uart3_getc();
+		DRIVE_BLOCK
+		{
+			if(StartFlag)
+			{
+				MagazineFront.Operate(false);
+				MagazineBack.Operate(false);
+			}
 		}
-		
-			
-			
-		lcd_gotoxy(0,0);
-		lcd_num(BackMotor.Controller.setpoint);
-		lcd_putch(' ');
-		
-		lcd_num(BackMotor.RPM);
 
-		lcd_gotoxy(0,1);
-		lcd_num(ThrowMotor.Position);
-		lcd_putch(' ');
-		lcd_num(ThrowMotor.Status);
-		lcd_putch(' ');
-		lcd_num(SideMotor.OCR);
-		lcd_putch(' ');
+		DRIVE_BLOCK
+		{
+			if(ArmHold)
+				ThrowMotor.StopMotor();
+			else
+				ThrowMotor.Operate( Rx_Buffer );
+		}
 
-		if(Rx_Buffer)
+		ff_capture_sample(BackMotor.RPM, BackMotor.Controller.setpoint, BackMotor.Ocr);
+	}
+	else
+	{
+			
+		DRIVE_BLOCK
 		{
-			lcd_putch(Rx_Buffer);
-		}	
-		else
+			StopMotors();
+		}
+#if LATENCY_STATS && !CMD_ISR_SAFETY
+		if(StopTimed)
 		{
-			lcd_putch('0');
+			StopTimed = false;
+			LAT_RECORD(LAT_STOP, lat_now() - StopStamp);
 		}
-		lcd_putch(' ');
-		if(StartFlag)
+#endif
+#if PID_TRAJECTORY
+		//coasting: the next spin-up ramps from the speed left
+		BackMotor.Controller.Reset_Reference(BackMotor.RPM);
+#endif
+
+		
+		DRIVE_BLOCK
 		{
-			lcd_putch( 65 );
+			if(ArmHold)
+				ThrowMotor.StopMotor();
+			else
+				ThrowMotor.Operate( 0 );
 		}
-		else
-			lcd_putch( 67 );
+		
 
+		DRIVE_BLOCK
+		{
+			if(Rx_Buffer ==  'd')
+			{
+				
+				MagazineBack.StopMotor();
+				MagazineFront.StopMotor();
 
+			}
+			else if(Rx_Buffer == 'D')			
+			{
+				MagazineBack.MoveD();
+				MagazineFront.MoveD();
 
+			}
+		}
+	}
 
-		RPM = SideMotor.RPM;
-			
-		if( Rx_Buffer == 'g')
+	Rx_Buffer = 0;		
+	rx = 0;	
+
+	RecordTrace();
+	
+	SIM_END(SIM_SPAN_CONTROL);
+}
+
+
+#if CMD_ISR_SAFETY
+//in USART3_RX_vect, ahead of every task; returns 1 for the bytes acted on
+//here, the rest are queued for CommandTask
+static uint8_t SafetyCommand(uint8_t c)
+{
+	if(c == 's')
+	{
+		LAT_BEGIN(LAT_STOP);
+		StartFlag = false;
+		StopMotors();
+		MagazineBack.StopMotor();
+		MagazineFront.StopMotor();
+		LAT_END(LAT_STOP);
+		return 1;
+	}
+	if(c == 'h')
+	{
+		ArmHold = true;
+		ThrowMotor.StopMotor();
+		return 1;
+	}
+	if(c == 'H')
+	{
+		ArmHold = false;
+		return 1;
+	}
+	if(c == 'g')
+	{
+		//running from here on; the magazine load and the motors' own
+		//handling of 'g' still come from the tasks
+		if(!StartFlag)
 		{
-			if(!StartFlag)
-			{
-				MagazineBack.VirginityFlag = true;
-				MagazineFront.VirginityFlag = true;
-			}
-			StartFlag = true;
+			MagazineBack.VirginityFlag = true;
+			MagazineFront.VirginityFlag = true;
+		}
+		StartFlag = true;
+	}
+	return 0;
+}
+#elif LATENCY_STATS
+//stop timed from here to ControlTask, to compare with the ISR path
+static uint8_t SafetyCommand(uint8_t c)
+{
+	if(c == 's')
+	{
+		StopStamp = lat_now();
+		StopTimed = true;
+	}
+	return 0;
+}
+#else
+static uint8_t SafetyCommand(uint8_t)
+{
+	return 0;
+}
+#endif
+
+//every uart3 byte: command frames are collected here, whole, and the
+//ASCII bytes between them go on as before. Once the remote has sent
+//frames, an ASCII start, profile or save is more likely a frame byte
+//taken out of context than a command, and is dropped
+static uint8_t Uart3Command(uint8_t c)
+{
+	switch(cmd_rx(c, (uint16_t)sched_ticks()))
+	{
+	case CMD_RX_STOP:
+		SafetyCommand('s');
+		return 1;
+	case CMD_RX_FRAME:
+		return 1;
+	}
+	if(cmd_framed() && (c == 'g' || c == 'w' || c == 'W' || (c >= '0' && c <= '9')))
+		return 1;
+	return SafetyCommand(c);
+}
+
+
+//'g' and 's', from a byte or a frame
+static void StartRun(void)
+{
+	if(!StartFlag)
+	{
+		MagazineBack.VirginityFlag = true;
+		MagazineFront.VirginityFlag = true;
+	}
+	StartFlag = true;
 
-			if(ThrowMotor.Position == HOMEPOSITION)
+	if(ThrowMotor.Position == HOMEPOSITION)
+	{
+		DRIVE_BLOCK
+		{
+			if(StartFlag)
 			{
 				TempReturn1 = MagazineFront.Operate(true);
 				TempReturn2 = MagazineBack.Operate(true);
 			}
-			
+		}
+	}
+}
 
+static void StopRun(void)
+{
+	StartFlag = false;
+	DRIVE_BLOCK
+	{
+		MagazineBack.StopMotor();
+		MagazineFront.StopMotor();
+	}
+}
 
-		}
-		else if( Rx_Buffer == 's' || rx == 'S')
-		{
-			StartFlag = false;
-			MagazineBack.StopMotor();
-			MagazineFront.StopMotor();
-			
-			
-		}
-		
-	
 
-		if(StartFlag == true)
+/* a command frame, checked whole in USART3_RX_vect; a repeat of the last
+   one is only answered. Start and stop also go to ControlTask in Rx_Buffer
+   as if sent as bytes */
+static void ApplyFrame(const CmdFrame &frame)
+{
+	if(frame.status == CMD_OK && !frame.duplicate)
+	{
+		for(uint8_t i = 0; i < frame.count; ++i)
 		{
-	
-			if(uart0_available())
+			const CmdItem &item = frame.items[i];
+
+			if(item.type == CMD_ITEM_BITS)
 			{
-				rx = uart0_getc();
-				if(rx == '.')
+				if(item.arg & _BV(STOP_PLATFORM_MOTOR_BIT))
 				{
-					StartFlag = false;
+					StopRun();
+					Rx_Buffer = 's';
 				}
+				else if(item.arg & _BV(START_PLATFORM_MOTOR_BIT))
+				{
+					StartRun();
+					Rx_Buffer = 'g';
+				}
+				if(item.arg & _BV(INCREASE_FIRST_MOTOR_SPEED_BIT))
+					BackMotor.Controller.Inc_Setpoint();
+				if(item.arg & _BV(DECREASE_FIRST_MOTOR_SPEED_BIT))
+					BackMotor.Controller.Dcr_Setpoint();
+				if(item.arg & _BV(INCREASE_SECOND_MOTOR_SPEED_BIT))
+					FrontMotor.Controller.Inc_Setpoint();
+				if(item.arg & _BV(DECREASE_SECOND_MOTOR_SPEED_BIT))
+					FrontMotor.Controller.Dcr_Setpoint();
+			}
+			else if(item.type == CMD_ITEM_SETPOINT)
+			{
+				if(item.arg == CMD_MOTOR_BACK)
+					BackMotor.Controller.Set_Setpoint(item.value);
+				else
+					FrontMotor.Controller.Set_Setpoint(item.value);
 			}
+			else
+			{
+				//at the next control tick, over setpoints set above
+				profile_request(item.arg);
+			}
+		}
+	}
 
-			MotorA_Return = BackMotor.Operate(rx, Rx_Buffer);
-			FrontMotor.SetOcrValue(BackMotor.Ocr);
+	uint8_t data[CMD_ACK_DATA_SIZE];
+	bool reply = cmd_wants_data(frame);
+	if(reply)
+	{
+		int16_t back  = BackMotor.RPM;
+		int16_t front = FrontMotor.RPM;
+
+		data[0] = StartFlag;
+		data[1] = back;
+		data[2] = back >> 8;
+		data[3] = front;
+		data[4] = front >> 8;
+	}
+	cmd_ack(frame, reply ? data : 0);
+}
 
-			
-			
-			MotorS_Return = SideMotor.Operate(rx, Rx_Buffer, 0);
 
+/* takes one byte (or frame) per port until the control task has consumed the last */
+static void CommandTask(void)
+{
+	CmdFrame frame;
 
-			MagazineFront.Operate(false);
-			MagazineBack.Operate(false);
+	if(!Rx_Buffer && cmd_take(frame))
+	{
+		ApplyFrame(frame);
+	}
+	else if(!Rx_Buffer && uart3_available())
+	{	
+		Rx_Buffer = uart3_getc();
 
-			ThrowMotor.Operate( Rx_Buffer );
-			
+		if( Rx_Buffer == 'g')
+		{
+			StartRun();
+		}
+		else if( Rx_Buffer == 's')
+		{
+			StopRun();
+		}
+		else if( Rx_Buffer == 'h' || Rx_Buffer == 'H')
+		{
+			//USART3_RX_vect takes these itself with CMD_ISR_SAFETY
+			ArmHold = (Rx_Buffer == 'h');
 			Rx_Buffer = 0;
-			rx = 0;
-			
-			uart0_putc('2');
-			uart0_putc(' ');
-			uart0_putint(BackMotor.RPM);
-			uart0_putc(' ');
-			uart0_putint(BackMotor.Controller.setpoint);
+		}
+		else if( Rx_Buffer == 'c')
+		{
+			//capture now; not a motor command
+			trace_trigger(TRACE_TRIGGER_COMMAND);
+			Rx_Buffer = 0;
+		}
+		else if( Rx_Buffer == 'f')
+		{
+			//feed-forward point once the back motor is steady
+			ff_capture_begin();
+			Rx_Buffer = 0;
+		}
+		else if( Rx_Buffer >= '0' && Rx_Buffer < '0' + PROFILE_COUNT)
+		{
+			//applied at the start of the next control tick
+			profile_request(Rx_Buffer - '0');
+			Rx_Buffer = 0;
+		}
+		else if( Rx_Buffer == 'w')
+		{
+			//setpoints into the active profile, hand tuned gains too;
+			//written in the background
+			uint8_t index = profile_active_index();
+			ThrowProfile profile = profile_active();
+			profile.backRpm  = BackMotor.Controller.setpoint;
+			profile.frontRpm = FrontMotor.Controller.setpoint == profile.backRpm ? 0 : FrontMotor.Controller.setpoint;
+#if PID_FIXED_POINT
+			if(!BackMotor.Controller.Is_Scheduled())
+			{
+				calib.kp = BackMotor.Controller.kpQ;
+				calib.ki = BackMotor.Controller.kiQ;
+				calib.kd = BackMotor.Controller.kdQ;
+				calib.present |= CALIB_GAINS;
+			}
+#endif
+			profile_save(index, profile);
+			profile_request(index);
+			Rx_Buffer = 0;
+		}
+		else if( Rx_Buffer == 'W')
+		{
+			//active profile and gains back to the factory values
+			uint8_t index = profile_active_index();
+			calib.present &= ~CALIB_GAINS;
+#if PID_GAIN_SCHEDULE
+			BackMotor.Controller.Use_Schedule();
+#endif
+			//without the schedule the Initialise() gains return at the next reset
+			profile_restore_default(index);
+			profile_request(index);
+			Rx_Buffer = 0;
+		}
+	}
 
-			uart0_putc(' ');
-			uart0_putint(BackMotor.Ocr);
+	if(StartFlag && !rx && uart0_available())
+	{
+		rx = uart0_getc();
+		if(rx == '.')
+		{
+			StartFlag = false;
+		}
+	}
+#if LATENCY_STATS
+	//'L' dumps the latency table, 'l' clears it; only while stopped
+	else if(!StartFlag && uart0_available())
+	{
+		unsigned char cmd = uart0_getc();
+		if(cmd == 'L')
+			lat_dump_begin();
+		else if(cmd == 'l')
+			lat_clear();
+	}
+#endif
+}
 
-			
-			uart0_putc(' ');
-			uart0_putint(FrontMotor.RPM);
-			uart0_putc(' ');
-			uart0_putint(FrontMotor.Controller.setpoint);
-			
-			uart0_putc(' ');
-			uart0_putint(FrontMotor.Ocr);
 
+static void TelemetryTask(void)
+{
+	//a queued save starts even while a capture is being sent
+	calib_step();
 
-			uart0_putc('\n');
-			uart0_putc('\r');
-			
-		
-		}
-		else
-		{
-				
-			BackMotor.StopMotor();
-			FrontMotor.StopMotor();
-			SideMotor.StopMotor();
+	//a finished capture goes out in place of the live frames
+	if(trace_dump_step())
+		return;
 
-			
-			ThrowMotor.Operate( 0 );
-			
+	if(ff_capture_step())
+	{
+		//the point is in the table now; keep it
+		ff_get_points(calib.ff);
+		calib.present |= CALIB_FF;
+		calib_save();
+#if PID_FEED_FORWARD
+		BackMotor.Controller.Use_Feed_Forward(true);
+#endif
+		return;
+	}
+#if LATENCY_STATS
+	//a dump line takes the place of a frame; paused while running
+	if(!StartFlag && lat_dump_step())
+		return;
+#endif
+	SendTelemetry(StartFlag);
+}
+
+
+static void DisplayTask(void)
+{
+	lcd_fb_gotoxy(0,0);
+	lcd_fb_num(BackMotor.Controller.setpoint);
+	lcd_fb_putch(' ');
+	
+	lcd_fb_num(BackMotor.RPM);
+
+	//CPU load, right aligned in the last four cells
+	lcd_fb_gotoxy(12,0);
+	lcd_fb_unum(sched_load(), 3);
+	lcd_fb_putch('%');
+
+	lcd_fb_gotoxy(0,1);
+	lcd_fb_num(ThrowMotor.Position);
+	lcd_fb_putch(' ');
+	lcd_fb_num(ThrowMotor.Status);
+	lcd_fb_putch(' ');
+	lcd_fb_num(SideMotor.OCR);
+	lcd_fb_putch(' ');
+
+	if(Rx_Buffer)
+	{
+		lcd_fb_putch(Rx_Buffer);
+	}	
+	else
+	{
+		lcd_fb_putch('0');
+	}
+	lcd_fb_putch(' ');
+	if(StartFlag)
+	{
+		lcd_fb_putch( 65 );
+	}
+	else
+		lcd_fb_putch( 67 );
+}
 
-			if(Rx_Buffer ==  'd')
-			{
-				
-				MagazineBack.StopMotor();
-				MagazineFront.StopMotor();
 
+int main(void)
+{
+	
+	MagazineLimit::pullup_on();
+
+
+	if(1)
+	{
+		char Count1;
+		MzMotorBack  PreBackMagazine;
+		MzMotorFront PreFrontMagazine;
+		PreFrontMagazine.Initialise();
+		PreBackMagazine.Initialise();
+		ThrowMotor.Initialise();
+
+
+		PreFrontMagazine.PreMoveD();
+		PreBackMagazine.PreMoveD();
+		ThrowMotor.Operate(1);
+
+		while(1)
+		{
+			if(!MagazineLimit::read())
+			{
+				++Count1;
 			}
-			else if(Rx_Buffer == 'D')			
+			if(Count1)
 			{
-				MagazineBack.MoveD();
-				MagazineFront.MoveD();
-
+				PreBackMagazine.StopMotor();
+				PreFrontMagazine.StopMotor();
+				break;
 			}
-			
-			Rx_Buffer = 0;
-			rx = 0;
-			
-			uart0_putc('1');
-			uart0_putc(' ');
-			uart0_putint(BackMotor.RPM);
-			uart0_putc(' ');
-			uart0_putint(BackMotor.Controller.setpoint);
+			ThrowMotor.Operate(0);
+		}
+		
+	}
 
-			uart0_putc(' ');
-			uart0_putint(BackMotor.Ocr);
 
-			
-			uart0_putc(' ');
-			uart0_putint(FrontMotor.RPM);
-			uart0_putc(' ');
-			uart0_putint(FrontMotor.Controller.setpoint);
-			
-			uart0_putc(' ');
-			uart0_putint(FrontMotor.Ocr);
+	initialise();
+
+	BackMotor.Initialise();
+	FrontMotor.Initialise();
+	//only the back PID runs; the front motor takes its Ocr (ControlTask)
+#if PID_GAIN_SCHEDULE
+	BackMotor.Controller.Use_Schedule();
+#endif
+#if PID_TRAJECTORY
+	BackMotor.Controller.Use_Trajectory(PID_TRAJ_RATE, PID_TRAJ_ACCEL);
+#endif
+	
 
 
-			uart0_putc('\n');
-			uart0_putc('\r');
+	
 
-			
-		}
+	
+	MagazineFront.Initialise();
+	MagazineBack.Initialise();
+	SideMotor.Initialise();
 
-		Rx_Buffer = 0;		
-		rx = 0;	
-		
+	BackMotor.StopMotor();
+	FrontMotor.StopMotor();
+	SideMotor.StopMotor();
+
+	
+
+	ThrowMotor.StopMotor();
+
+	ff_init();
+	calib_init();
+#if PID_FIXED_POINT
+	if(calib.present & CALIB_GAINS)
+	{
+		BackMotor.Controller.Set_PID_Q(calib.kp, calib.ki, calib.kd);
+	}
+#endif
+	if(calib.present & CALIB_FF)
+	{
+		//the flash table is only placeholders; measured points only
+		ff_set_points(calib.ff);
+#if PID_FEED_FORWARD
+		BackMotor.Controller.Use_Feed_Forward(true);
+#endif
+	}
+	profile_init();
+	profile_request(0);
+
+	capture_init();
+	quad_init(FrontQuad, BackQuad);
+
+	sched_init();
+	trace_arm(TRACE_PRETRIGGER);
+
+	uart3_set_rx_filter(Uart3Command);
+
+	sched_add(ControlTask,   CONTROL_PERIOD,   0);
+	sched_add(CommandTask,   COMMAND_PERIOD,   0);
+	sched_add(TelemetryTask, TELEMETRY_PERIOD, 1);
+	sched_add(DisplayTask,   DISPLAY_PERIOD,   2);
+
+	sei();
+	bluetooth_check();
+	
+	while(1)
+	{
+		LAT_BEGIN(LAT_LOOP);
+		uint8_t ran = sched_run();
+		LAT_END(LAT_LOOP);
+
+		if(!ran)
+			sched_idle();
 	}
 	
 	
@@ -326,52 +782,171 @@ int main(void)
 
 
 
+#if MOTORBACK_CAPTURE
+
+ISR(MOTORBACK_CAPT_vect)
+{
+	LAT_BEGIN(LAT_BACK_EDGE);
+	uint16_t icr = MotorBackTimer::icr();
+	bool wrapped = (MotorBackTimer::tifr() & _BV(MotorBackTimer::Tov)) && icr < 0x8000;
+	if(wrapped)
+		MotorBackTimer::tifr() = _BV(MotorBackTimer::Tov);
+
+	uint32_t period = capture_edge(BackCapture, icr, wrapped);
+	if(period)
+	{
+		BackMotor.Count   = rpm_filter_step(BackFilter, capture_count(period));
+		BackMotor.IntFlag = true;
+	}
+	LAT_END(LAT_BACK_EDGE);
+}
+
+
+ISR(MOTORBACK_TIMER_OVERFLOW_VECT)
+{
+	LAT_BEGIN(LAT_BACK_OVF);
+	if(capture_overflow(BackCapture))
+	{
+		BackMotor.RPM = 0;
+		rpm_filter_reset(BackFilter);
+	}
+	LAT_END(LAT_BACK_OVF);
+}
+
+#else
+
 ISR(MOTORBACK_INT_vect)
 {
-	BackMotor.Count   = READVALUE(MOTORBACK_TCNT);
-	MOTORBACK_TCNT = 0;
+	LAT_BEGIN(LAT_BACK_EDGE);
+	uint16_t count = MotorBackTimer::tcnt();
+	MotorBackTimer::tcnt() = 0;
+	BackMotor.Count   = rpm_filter_step(BackFilter, count);
 	BackMotor.IntFlag = true;
+	LAT_END(LAT_BACK_EDGE);
 }
 
 
 ISR(MOTORBACK_TIMER_OVERFLOW_VECT)
 {
+	LAT_BEGIN(LAT_BACK_OVF);
 	BackMotor.RPM = 0;
+	rpm_filter_reset(BackFilter);
+	LAT_END(LAT_BACK_OVF);
+}
+
+#endif
+
+#if SIDEMOTOR_CAPTURE
+
+ISR(SIDEMOTOR_CAPT_vect)
+{
+	LAT_BEGIN(LAT_SIDE_EDGE);
+	uint16_t icr = SideMotorTimer::icr();
+	bool wrapped = (SideMotorTimer::tifr() & _BV(SideMotorTimer::Tov)) && icr < 0x8000;
+	if(wrapped)
+		SideMotorTimer::tifr() = _BV(SideMotorTimer::Tov);
+
+	uint32_t period = capture_edge(SideCapture, icr, wrapped);
+	if(period)
+	{
+		SideMotor.Count   = capture_count(period);
+		SideMotor.IntFlag = true;
+	}
+	LAT_END(LAT_SIDE_EDGE);
 }
 
+
+ISR(SIDEMOTOR_TIMER_OVERFLOW_VECT)
+{
+	LAT_BEGIN(LAT_SIDE_OVF);
+	capture_overflow(SideCapture);
+	//SideMotor.RPM = 0;
+	LAT_END(LAT_SIDE_OVF);
+}
+
+#else
+
 ISR(SIDEMOTOR_INT_vect)
 {
-	SideMotor.Count   = READVALUE(SIDEMOTOR_TCNT);
-	SIDEMOTOR_TCNT = 0;
+	LAT_BEGIN(LAT_SIDE_EDGE);
+	SideMotor.Count   = SideMotorTimer::tcnt();
+	SideMotorTimer::tcnt() = 0;
 	SideMotor.IntFlag = true;
+	LAT_END(LAT_SIDE_EDGE);
 }
 
 
 ISR(SIDEMOTOR_TIMER_OVERFLOW_VECT)
 {
+	LAT_BEGIN(LAT_SIDE_OVF);
 	//SideMotor.RPM = 0;
+	LAT_END(LAT_SIDE_OVF);
 }
 
+#endif
+
+
+#if MOTORFRONT_CAPTURE
+
+ISR(MOTORFRONT_CAPT_vect)
+{
+	LAT_BEGIN(LAT_FRONT_EDGE);
+	uint16_t icr = MotorFrontTimer::icr();
+	bool wrapped = (MotorFrontTimer::tifr() & _BV(MotorFrontTimer::Tov)) && icr < 0x8000;
+	if(wrapped)
+		MotorFrontTimer::tifr() = _BV(MotorFrontTimer::Tov);
+
+	uint32_t period = capture_edge(FrontCapture, icr, wrapped);
+	if(period)
+	{
+		FrontMotor.Count   = rpm_filter_step(FrontFilter, capture_count(period));
+		FrontMotor.IntFlag = true;
+	}
+	LAT_END(LAT_FRONT_EDGE);
+}
 
 
 ISR(MOTORFRONT_TIMER_OVERFLOW_VECT)
 {
+	LAT_BEGIN(LAT_FRONT_OVF);
+	if(capture_overflow(FrontCapture))
+	{
+		FrontMotor.RPM = 0;
+		rpm_filter_reset(FrontFilter);
+	}
+	LAT_END(LAT_FRONT_OVF);
+}
+
+#else
+
+ISR(MOTORFRONT_TIMER_OVERFLOW_VECT)
+{
+	LAT_BEGIN(LAT_FRONT_OVF);
 	FrontMotor.RPM = 0;
+	rpm_filter_reset(FrontFilter);
+	LAT_END(LAT_FRONT_OVF);
 }
 
 
 ISR(MOTORFRONT_INT_vect)
 {
-	FrontMotor.Count   = READVALUE(MOTORFRONT_TCNT);
-	MOTORFRONT_TCNT = 0;
+	LAT_BEGIN(LAT_FRONT_EDGE);
+	uint16_t count = MotorFrontTimer::tcnt();
+	MotorFrontTimer::tcnt() = 0;
+	FrontMotor.Count   = rpm_filter_step(FrontFilter, count);
 	FrontMotor.IntFlag = true;
+	LAT_END(LAT_FRONT_EDGE);
 }
 
+#endif
+
 
 ISR(PID_TIMER_OVERFLOW_vect)
 {
+	LAT_BEGIN(LAT_PID_TIMER);
 	++BackMotor.Controller.timer;
 	++FrontMotor.Controller.timer;
+	LAT_END(LAT_PID_TIMER);
 }
 
 
@@ -392,44 +967,63 @@ ISR(BL_INT_vect)
 */
 
 
-ISR(EN_FRONT_INT_vect)
+template <class E>
+static inline void EncoderMove(E &encoder, int8_t step)
 {
-	
-	if(!READ(ENCODERFRONTB))
+	if(step > 0)
 	{
-		MagazineFront.Encoder.UpFlag = true;
-		++MagazineFront.Encoder.Count;
+		encoder.UpFlag = true;
+		++encoder.Count;
 	}
-	else
+	else if(step < 0)
 	{
-		MagazineFront.Encoder.UpFlag = false;
-		--MagazineFront.Encoder.Count;
+		encoder.UpFlag = false;
+		--encoder.Count;
 	}
+}
 
 
+ISR(EN_FRONT_INT_vect)
+{
+	LAT_BEGIN(LAT_EN_FRONT);
+#if EN_FRONT_4X
+	int8_t edge = quad_step(FrontQuad, en_front_ab());
+#else
+	int8_t edge = quad_step_a(FrontQuad, en_front_ab());
+#endif
+	EncoderMove(MagazineFront.Encoder, quad_count(FrontQuad, edge, EN_FRONT_EDGES));
+	LAT_END(LAT_EN_FRONT);
 }
 
 
 ISR(EN_BACK_INT_vect)
-{	
-	if(READ(ENCODERBACKB))
-	{
-		MagazineBack.Encoder.UpFlag = true;
-		++MagazineBack.Encoder.Count;
-	}
-	else
-	{
-		MagazineBack.Encoder.UpFlag = false;
-		--MagazineBack.Encoder.Count;
-	}
-
-	
-
+{
+	LAT_BEGIN(LAT_EN_BACK);
+#if EN_BACK_4X
+	int8_t edge = quad_step(BackQuad, en_back_ab());
+#else
+	int8_t edge = quad_step_a(BackQuad, en_back_ab());
+#endif
+	EncoderMove(MagazineBack.Encoder, quad_count(BackQuad, edge, EN_BACK_EDGES));
+	LAT_END(LAT_EN_BACK);
 }
 
 
+#if EN_FRONT_4X || EN_BACK_4X
 
+/* B channels; a decoder whose pins did not change steps by 0 */
+ISR(EN_B4X_PCINT_vect)
+{
+	LAT_BEGIN(LAT_EN_B4X);
+#if EN_FRONT_4X
+	EncoderMove(MagazineFront.Encoder,
+				quad_count(FrontQuad, quad_step(FrontQuad, en_front_ab()), EN_FRONT_EDGES));
+#endif
+#if EN_BACK_4X
+	EncoderMove(MagazineBack.Encoder,
+				quad_count(BackQuad, quad_step(BackQuad, en_back_ab()), EN_BACK_EDGES));
+#endif
+	LAT_END(LAT_EN_B4X);
+}
 
-
-
-
+#endif
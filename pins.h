@@ -0,0 +1,230 @@
+/*
+ * pins.h
+ *
+ * Created: 10/17/2026 10:26:31 PM
+ *  Author: Bibek Shrestha
+ *
+ * Typed I/O pins and peripheral descriptors. Pin<PortD, 2> is an empty
+ * type whose static inline members touch one fixed register address, the
+ * same access as PORTD |= _BV(2). Nothing is stored; a pin is passed
+ * around as a type (typedef or template argument).
+ *
+ * Not checked yet: that avr-gcc -Os turns set()/clear() into one SBI/CBI
+ * and read() into SBIC/SBIS for ports in I/O space (A-G), as it does for
+ * the plain expressions. Compare the avr-objdump -d of an image before
+ * relying on it in a timing critical ISR; ports H-L have no SBI/CBI and
+ * always take a read-modify-write.
+ *
+ * ExtInt<N> describes external interrupt INTn (its EICR bits, EIMSK/EIFR
+ * bit and pin) and Timer16<N> the 16 bit timer n (capture/overflow bits,
+ * ICPn pin and OCnA-C pins), so a motor's interrupt and timer set-up
+ * follows from the two numbers in headers.h. Only the ISR vector names
+ * are still macros there, since ISR() takes nothing else.
+ *
+ * The toolchain is C++98: no constexpr, constants are enums.
+ */
+
+
+#ifndef PINS_H_
+#define PINS_H_
+
+#include <stdint.h>
+#include <avr/io.h>
+
+
+/* "D,2" style pairs from headers.h */
+#define PIN_TYPE2(port, bit)	Pin<Port ## port, bit>
+#define PIN_TYPE(x)				PIN_TYPE2(x)
+#define PIN_PORT2(port, bit)	PORT ## port
+#define PIN_PORT(x)				PIN_PORT2(x)
+#define PIN_BIT2(port, bit)		bit
+#define PIN_BIT(x)				PIN_BIT2(x)
+
+
+#define PINS_PORT(name, id)													\
+	struct Port ## name														\
+	{																		\
+		enum { Id = id };													\
+		static volatile uint8_t &pin(void)  { return PIN ## name; }			\
+		static volatile uint8_t &ddr(void)  { return DDR ## name; }			\
+		static volatile uint8_t &port(void) { return PORT ## name; }		\
+	};
+
+#ifdef PORTA
+PINS_PORT(A, 0)
+#endif
+#ifdef PORTB
+PINS_PORT(B, 1)
+#endif
+#ifdef PORTC
+PINS_PORT(C, 2)
+#endif
+#ifdef PORTD
+PINS_PORT(D, 3)
+#endif
+#ifdef PORTE
+PINS_PORT(E, 4)
+#endif
+#ifdef PORTF
+PINS_PORT(F, 5)
+#endif
+#ifdef PORTG
+PINS_PORT(G, 6)
+#endif
+#ifdef PORTH
+PINS_PORT(H, 7)
+#endif
+#ifdef PORTJ
+PINS_PORT(J, 8)
+#endif
+#ifdef PORTK
+PINS_PORT(K, 9)
+#endif
+#ifdef PORTL
+PINS_PORT(L, 10)
+#endif
+
+#define PINS_PORT_COUNT		11
+
+
+template <class P, uint8_t Bit>
+struct Pin
+{
+	typedef P Port;
+
+	/* bits of a port are checked at compile time too */
+	typedef char BitInRange[Bit < 8 ? 1 : -1];
+
+	enum { PortId = P::Id, Mask = 1 << Bit, Id = P::Id * 8 + Bit };
+
+	static void output(void)	{ P::ddr() |= Mask; }
+	static void input(void)		{ P::ddr() &= ~Mask; }
+	static void set(void)		{ P::port() |= Mask; }
+	static void clear(void)		{ P::port() &= ~Mask; }
+	static void toggle(void)	{ P::port() ^= Mask; }
+	static uint8_t read(void)	{ return (P::pin() & Mask) ? 1 : 0; }
+
+	static void pullup_on(void)		{ input(); set(); }
+	static void pullup_off(void)	{ input(); clear(); }
+};
+
+/* Pin<PortL, 3> without the comma, for pins written into list macros */
+template <class P>
+struct PortPins
+{
+	template <uint8_t B> struct Bit : Pin<P, B> {};
+};
+
+#define PIN_ON(port, bit)		PortPins<Port ## port>::Bit<bit>
+
+
+/* INT0-3 are PD0-3, INT4-7 are PE4-7 on the ATmega640/1280/2560 */
+template <uint8_t N, bool High = (N >= 4)> struct ExtIntPin;
+template <uint8_t N> struct ExtIntPin<N, false> { typedef Pin<PortD, N> Type; };
+template <uint8_t N> struct ExtIntPin<N, true>  { typedef Pin<PortE, N> Type; };
+
+template <uint8_t N>
+struct ExtInt
+{
+	typedef char IntInRange[N < 8 ? 1 : -1];
+	typedef typename ExtIntPin<N>::Type Pin;
+
+	enum { Number = N, Mask = 1 << N, Isc0 = 2 * (N & 3), Isc1 = 2 * (N & 3) + 1 };
+
+	static volatile uint8_t &eicr(void) { return N < 4 ? EICRA : EICRB; }
+
+	static void enable(void)		{ EIMSK |= Mask; }
+	static void disable(void)		{ EIMSK &= ~Mask; }
+	static void clear_flag(void)	{ EIFR = Mask; }
+
+	static void any_edge(void)
+	{
+		eicr() = (eicr() & ~_BV(Isc1)) | _BV(Isc0);
+	}
+	static void rising_edge(void)
+	{
+		eicr() |= _BV(Isc1) | _BV(Isc0);
+	}
+};
+
+
+/*
+ * 16 bit timers. The control bits sit in the same positions on timers
+ * 1, 3, 4 and 5, so the timer 1 names are used for all. OCnA-C are three
+ * neighbouring bits of one port on each of them.
+ */
+template <uint8_t N> struct Timer16;
+
+#define PINS_TIMER16(n, icpPort, icpBit, ocPort, ocaBit)						\
+	template <> struct Timer16<n>												\
+	{																			\
+		typedef Pin<Port ## icpPort, icpBit> IcpPin;							\
+		typedef Pin<Port ## ocPort, ocaBit> OcaPin;								\
+		typedef Pin<Port ## ocPort, ocaBit + 1> OcbPin;							\
+		typedef Pin<Port ## ocPort, ocaBit + 2> OccPin;							\
+		enum { Number = n, Ices = ICES1, Icnc = ICNC1, Tov = TOV1, Icf = ICF1,	\
+			   Icie = ICIE1, Toie = TOIE1 };									\
+		static volatile uint8_t  &tccrb(void) { return TCCR ## n ## B; }		\
+		static volatile uint16_t &tcnt(void)  { return TCNT ## n; }				\
+		static volatile uint16_t &icr(void)   { return ICR ## n; }				\
+		static volatile uint8_t  &tifr(void)  { return TIFR ## n; }				\
+		static volatile uint8_t  &timsk(void) { return TIMSK ## n; }			\
+	};
+
+#ifdef TCNT1
+PINS_TIMER16(1, D, 4, B, 5)
+#endif
+#ifdef TCNT3
+PINS_TIMER16(3, E, 7, E, 3)
+#endif
+#ifdef TCNT4
+PINS_TIMER16(4, L, 0, H, 3)
+#endif
+#ifdef TCNT5
+PINS_TIMER16(5, L, 1, L, 3)
+#endif
+
+/* 8 bit timers 0 and 2, only their OCnA/OCnB pins */
+template <uint8_t N> struct Timer8;
+
+#define PINS_TIMER8(n, ocaPort, ocaBit, ocbPort, ocbBit)						\
+	template <> struct Timer8<n>												\
+	{																			\
+		typedef Pin<Port ## ocaPort, ocaBit> OcaPin;							\
+		typedef Pin<Port ## ocbPort, ocbBit> OcbPin;							\
+		enum { Number = n };													\
+	};
+
+#ifdef TCNT0
+PINS_TIMER8(0, B, 7, G, 5)
+#endif
+#ifdef TCNT2
+PINS_TIMER8(2, B, 4, H, 6)
+#endif
+
+
+/*
+ * Compile-time claim checks. A list macro names every claimed pin (as a
+ * Pin type) or timer (as a number); no two entries may be the same. Per
+ * port, the OR of the claimed bit masks equals their sum only if no bit
+ * is there twice. Fails to compile with "size of array is negative".
+ *
+ *   #define BOARD_PINS(X, port) X(MotorBackRpmPin, port) X(EnFrontA, port)
+ *   PINS_CHECK_PORT(BOARD_PINS, PortD)
+ */
+#define PINS_ON_PORT(pin, port)		(((int)pin::PortId == (int)port::Id) ? (unsigned)pin::Mask : 0u)
+#define PINS_OR(pin, port)			| PINS_ON_PORT(pin, port)
+#define PINS_SUM(pin, port)			+ PINS_ON_PORT(pin, port)
+
+#define PINS_CHECK_PORT(list, port)													\
+	typedef char PinClaimedTwiceOn ## port											\
+		[((0u list(PINS_OR, port)) == (0u list(PINS_SUM, port))) ? 1 : -1];
+
+#define PINS_TIMER_OR(n)			| (1u << (n))
+#define PINS_TIMER_SUM(n)			+ (1u << (n))
+
+#define PINS_CHECK_TIMERS(list)														\
+	typedef char TimerClaimedTwice													\
+		[((0u list(PINS_TIMER_OR)) == (0u list(PINS_TIMER_SUM))) ? 1 : -1];
+
+#endif /* PINS_H_ */
@@ -0,0 +1,103 @@
+/*
+ * profile.cpp
+ *
+ * Created: 10/18/2026 3:52:27 AM
+ *  Author: Bibek Shrestha
+ */
+
+
+#include "profile.h"
+#include "calib.h"
+
+#include <avr/pgmspace.h>
+
+
+/*
+ * Zone 0 is the old power-up setpoint. The rest are placeholders to be
+ * set on the field and saved over ('w' on uart3).
+ */
+const ThrowProfile profile_defaults[PROFILE_COUNT] PROGMEM =
+{
+	/* back  front  magazine */
+	{ 1500,     0, PROFILE_MAGAZINE_KEEP },
+	{ 1200,     0, PROFILE_MAGAZINE_KEEP },
+	{ 1800,     0, PROFILE_MAGAZINE_KEEP },
+	{ 2100,     0, PROFILE_MAGAZINE_KEEP },
+	{ 2400,     0, PROFILE_MAGAZINE_KEEP },
+	{ 2700,     0, PROFILE_MAGAZINE_KEEP },
+	{ 3000,     0, PROFILE_MAGAZINE_KEEP },
+	{ 1000,     0, PROFILE_MAGAZINE_STOP },
+};
+
+static ThrowProfile profiles[PROFILE_COUNT];
+static uint8_t active;
+static volatile uint8_t requested;		/* index + 1, 0 for none */
+
+
+static void profile_load(uint8_t index)
+{
+	if (calib.profileMask & (1 << index))
+		profiles[index] = calib.profiles[index];
+	else
+		memcpy_P(&profiles[index], &profile_defaults[index], sizeof(ThrowProfile));
+}
+
+void profile_init(void)
+{
+	for (uint8_t i = 0; i < PROFILE_COUNT; ++i)
+		profile_load(i);
+	active = 0;
+	requested = 0;
+}
+
+void profile_request(uint8_t index)
+{
+	if (index < PROFILE_COUNT)
+		requested = index + 1;
+}
+
+bool profile_take(ThrowProfile &profile)
+{
+	uint8_t r = requested;				/* one byte, no lock needed */
+
+	if (!r)
+		return false;
+	requested = 0;
+	active = r - 1;
+	profile = profiles[active];
+	return true;
+}
+
+uint8_t profile_active_index(void)
+{
+	return active;
+}
+
+const ThrowProfile &profile_active(void)
+{
+	return profiles[active];
+}
+
+void profile_save(uint8_t index, const ThrowProfile &profile)
+{
+	if (index >= PROFILE_COUNT)
+		return;
+	calib.profiles[index] = profile;
+	calib.profileMask |= (uint8_t)(1 << index);
+	calib_save();
+	profile_load(index);
+}
+
+void profile_restore_default(uint8_t index)
+{
+	if (index >= PROFILE_COUNT)
+		return;
+	calib.profileMask &= (uint8_t)~(1 << index);
+	calib_save();
+	profile_load(index);
+}
+
+bool profile_overridden(uint8_t index)
+{
+	return index < PROFILE_COUNT && (calib.profileMask & (1 << index));
+}
@@ -0,0 +1,62 @@
+/*
+ * profile.h
+ *
+ * Created: 10/18/2026 3:52:27 AM
+ *  Author: Bibek Shrestha
+ *
+ * Throw profiles, one per target zone: the back and front flywheel RPMs
+ * and what the magazine does, switched as a whole instead of nudging
+ * setpoints 10 RPM at a time. The side motor and the arm keep running on
+ * their own; their classes take no setpoint or timing from here.
+ *
+ * Factory values are in flash (profile_defaults[], profile.cpp). Each
+ * profile can be overridden from the field; the overrides are kept in the
+ * calibration record (calib.h). profile_init() puts all of them in RAM
+ * once, so selecting one never touches the EEPROM.
+ *
+ * profile_request() (a command byte) only marks the profile; the control
+ * task picks it up with profile_take() at the start of its next tick and
+ * applies all of it there, so no tick runs on half a profile.
+ */
+
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <stdint.h>
+
+#define PROFILE_COUNT			8
+
+/* ThrowProfile.magazine */
+#define PROFILE_MAGAZINE_KEEP	0		/* leave the magazines as they are */
+#define PROFILE_MAGAZINE_LOAD	1		/* feed, as 'g' does at the home position */
+#define PROFILE_MAGAZINE_STOP	2
+
+struct ThrowProfile
+{
+	int16_t  backRpm;
+	int16_t  frontRpm;					/* 0: same as the back */
+	uint8_t  magazine;					/* PROFILE_MAGAZINE_* */
+};
+
+/* after calib_init() */
+void profile_init(void);
+
+/* from a command; out of range indexes are ignored */
+void profile_request(uint8_t index);
+
+/* in the control task: true with the profile to apply if one was requested */
+bool profile_take(ThrowProfile &profile);
+
+uint8_t profile_active_index(void);
+const ThrowProfile &profile_active(void);
+
+/*
+ * Field overrides, queued with calib_save(). A saved profile is used
+ * from the next profile_request() of it.
+ */
+void profile_save(uint8_t index, const ThrowProfile &profile);
+void profile_restore_default(uint8_t index);
+bool profile_overridden(uint8_t index);
+
+#endif /* PROFILE_H_ */
@@ -0,0 +1,62 @@
+/*
+ * quadrature.cpp
+ *
+ * Created: 10/17/2026 10:48:02 PM
+ *  Author: Bibek Shrestha
+ */ 
+
+
+#include "declarations.h"
+#include "quadrature.h"
+#include "board.h"
+
+
+/* [(old << 2) | new], forward is 00 -> 10 -> 11 -> 01 -> 00 */
+const int8_t quad_table[16] =
+{
+	 0, -1, +1, QUAD_ILLEGAL,
+	+1,  0, QUAD_ILLEGAL, -1,
+	-1, QUAD_ILLEGAL,  0, +1,
+	QUAD_ILLEGAL, +1, -1,  0,
+};
+
+
+/*
+ * Call after the magazines' Initialise(): A on both edges, B on pin
+ * change for the 4x encoders, and the decoders seeded with the pins.
+ */
+void quad_init(QuadDecoder &front, QuadDecoder &back)
+{
+	EnFrontInt::disable();
+	EnBackInt::disable();
+
+	EnFrontInt::any_edge();
+	EnBackInt::any_edge();
+
+#if EN_FRONT_4X
+	EnFrontB::input();
+	REGISTER_SET1(EN_B4X_PCMSK, EN_FRONT_B4X_PCINT);
+#endif
+#if EN_BACK_4X
+	EnBackB::input();
+	REGISTER_SET1(EN_B4X_PCMSK, EN_BACK_B4X_PCINT);
+#endif
+#if EN_FRONT_4X || EN_BACK_4X
+	PCIFR = _BV(EN_B4X_PCIF);
+	REGISTER_SET1(PCICR, EN_B4X_PCIE);
+#endif
+
+	front.state = en_front_ab();
+	front.sub = 0;
+	front.errors = 0;
+	front.position = 0;
+	back.state = en_back_ab();
+	back.sub = 0;
+	back.errors = 0;
+	back.position = 0;
+
+	EnFrontInt::clear_flag();
+	EnBackInt::clear_flag();
+	EnFrontInt::enable();
+	EnBackInt::enable();
+}
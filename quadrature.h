@@ -0,0 +1,108 @@
+/*
+ * quadrature.h
+ *
+ * Created: 10/17/2026 10:48:02 PM
+ *  Author: Bibek Shrestha
+ *
+ * Table driven quadrature decoder for the magazine encoders. The state is
+ * (A << 1) | B; old and new state index a 16 entry table giving +1, -1,
+ * 0 or QUAD_ILLEGAL (both channels changed, an edge was lost). Contact
+ * bounce walks back and forth across one transition and cancels instead
+ * of counting.
+ *
+ * The magazine code keeps its Encoder.Count in the old unit, one count per
+ * A cycle: edges are collected in sub and a count is passed on every
+ * EN_xxx_EDGES edges, so calibrated positions stay valid while the count
+ * no longer runs away on jitter.
+ *
+ * The full resolution count is position, one per decoded edge (2 or 4
+ * per A cycle, see EN_xxx_EDGES in headers.h); read it with
+ * quad_position(). A step target calibrated in Encoder.Count is moved to
+ * that unit with EN_FRONT_TARGET()/EN_BACK_TARGET().
+ */ 
+
+
+#ifndef QUADRATURE_H_
+#define QUADRATURE_H_
+
+#include <stdint.h>
+#include <util/atomic.h>
+
+#define QUAD_ILLEGAL		2
+
+struct QuadDecoder
+{
+	uint8_t  state;			/* (A << 1) | B after the last edge */
+	int8_t   sub;			/* edges since the last whole count */
+	uint16_t errors;		/* illegal transitions, saturating */
+	int32_t  position;		/* edges, full resolution */
+};
+
+extern const int8_t quad_table[16];
+
+/* both channels interrupt: ab is the full new state */
+static inline int8_t quad_step(QuadDecoder &q, uint8_t ab)
+{
+	int8_t d = quad_table[(q.state << 2) | ab];
+
+	q.state = ab;
+	if (d == QUAD_ILLEGAL)
+	{
+		if (q.errors != 0xFFFF)
+			++q.errors;
+		return 0;
+	}
+	return d;
+}
+
+/*
+ * Only A interrupts and B is sampled. B's own edges are not seen, so the
+ * old state takes the current B; an A interrupt without A changing means
+ * a pulse was too short to catch.
+ */
+static inline int8_t quad_step_a(QuadDecoder &q, uint8_t ab)
+{
+	if (!((q.state ^ ab) & 2))
+	{
+		if (q.errors != 0xFFFF)
+			++q.errors;
+		q.state = ab;
+		return 0;
+	}
+	q.state = (q.state & 2) | (ab & 1);
+	return quad_step(q, ab);
+}
+
+/* whole counts out of edges: returns +1/-1 every edgesPerCount edges */
+static inline int8_t quad_count(QuadDecoder &q, int8_t d, int8_t edgesPerCount)
+{
+	q.position += d;
+	q.sub += d;
+	if (q.sub >= edgesPerCount)
+	{
+		q.sub -= edgesPerCount;
+		return 1;
+	}
+	if (q.sub <= -edgesPerCount)
+	{
+		q.sub += edgesPerCount;
+		return -1;
+	}
+	return 0;
+}
+
+/* position from outside the encoder ISRs */
+static inline int32_t quad_position(const QuadDecoder &q)
+{
+	int32_t position;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		position = q.position;
+	}
+	return position;
+}
+
+void quad_init(QuadDecoder &front, QuadDecoder &back);
+
+#endif /* QUADRATURE_H_ */
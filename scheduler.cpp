@@ -0,0 +1,223 @@
+/*
+ * scheduler.cpp
+ *
+ * Created: 10/17/2026 5:12:08 PM
+ *  Author: Bibek Shrestha
+ */ 
+
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#if SCHED_IDLE_SLEEP
+#include <avr/sleep.h>
+#endif
+
+#include "scheduler.h"
+#include "latency.h"
+
+
+static SchedTask sched_table[SCHED_MAX_TASKS];
+static uint8_t sched_count;
+static volatile uint32_t sched_tick;
+
+static uint32_t sched_idle_counts;		/* in the current load window */
+static uint32_t sched_window_start;		/* tick */
+static uint8_t sched_load_percent;
+
+
+/*
+ * Time in timer counts. Wraps at 2^32 together with the tick counter,
+ * so differences stay right across the wrap.
+ */
+static uint32_t sched_clock(void)
+{
+	uint32_t ticks;
+	uint16_t counts;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ticks = sched_tick;
+		/* counts since the last match; OCR already points at the next one */
+		counts = SCHED_TCNT - (SCHED_OCR - SCHED_COUNTS);
+		/* compare matched, ISR still pending */
+		if (counts >= SCHED_COUNTS)
+		{
+			++ticks;
+			counts -= SCHED_COUNTS;
+		}
+	}
+	return ticks * SCHED_COUNTS + counts;
+}
+
+static uint16_t sched_us(uint32_t counts)
+{
+	if (counts > 0xFFFFUL * SCHED_COUNTS_PER_US)
+		return 0xFFFF;
+	return counts / SCHED_COUNTS_PER_US;
+}
+
+
+void sched_init(void)
+{
+	SCHED_TCCRA = 0;		/* normal mode, OCnA-C disconnected */
+	SCHED_TCCRB = SCHED_CLOCK;
+	SCHED_TCNT = 0;
+	SCHED_OCR = SCHED_COUNTS;
+	SCHED_TIFR = _BV(SCHED_OCF);
+	SCHED_TIMSK |= _BV(SCHED_OCIE);
+	sched_idle_counts = 0;
+	sched_window_start = sched_ticks();
+}
+
+uint8_t sched_add(void (*run)(void), uint16_t period, uint16_t offset)
+{
+	if (sched_count >= SCHED_MAX_TASKS || !period)
+		return 0xFF;
+
+	SchedTask &task = sched_table[sched_count];
+	task.run = run;
+	task.period = period;
+	task.due = sched_ticks() + offset;
+	task.runTime = task.maxRunTime = task.maxLateness = 0;
+	task.runs = task.overruns = 0;
+	return sched_count++;
+}
+
+/* close the load window once it is full */
+static void sched_account(uint32_t now)
+{
+	uint32_t window = now - sched_window_start;
+
+	if (window < SCHED_LOAD_WINDOW)
+		return;
+
+	uint32_t total = window * SCHED_COUNTS;
+	uint32_t idle = sched_idle_counts < total ? sched_idle_counts : total;
+	sched_load_percent = (uint8_t)(((total - idle) * 100 + total / 2) / total);
+	sched_idle_counts = 0;
+	sched_window_start = now;
+}
+
+uint8_t sched_run(void)
+{
+	uint32_t now = sched_ticks();
+
+	sched_account(now);
+
+	for (uint8_t i = 0; i < sched_count; ++i)
+	{
+		SchedTask &task = sched_table[i];
+		uint32_t late = now - task.due;
+
+		if ((int32_t)late < 0)
+			continue;
+
+		uint32_t start = sched_clock();
+		uint32_t lateCounts = start - task.due * SCHED_COUNTS;
+		uint16_t lateness = sched_us(lateCounts);
+
+		LAT_RECORD(LAT_TASK0 + i, lateCounts > 0xFFFF ? 0xFFFF : lateCounts);
+
+		task.run();
+
+		task.runTime = sched_us(sched_clock() - start);
+		if (task.runTime > task.maxRunTime)
+			task.maxRunTime = task.runTime;
+		if (lateness > task.maxLateness)
+			task.maxLateness = lateness;
+		++task.runs;
+
+		/* keep the phase; if whole periods went by, drop them */
+		task.due += task.period;
+		if (late >= task.period)
+		{
+			task.overruns += late / task.period;
+			task.due += (late / task.period) * task.period;
+		}
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Only the low byte of the tick is compared and only TCNT5L is read,
+ * both single byte loads, so the wait never masks interrupts.
+ */
+void sched_idle(void)
+{
+	uint8_t seen = (uint8_t)sched_tick;
+
+#if SCHED_IDLE_SLEEP
+	uint32_t start = sched_clock();
+
+	set_sleep_mode(SLEEP_MODE_IDLE);
+	while ((uint8_t)sched_tick == seen)
+	{
+		/* the tick must not slip in between the check and the sleep */
+		cli();
+		if ((uint8_t)sched_tick == seen)
+		{
+			sleep_enable();
+			sei();
+			sleep_cpu();
+			sleep_disable();
+		}
+		sei();
+	}
+	sched_idle_counts += sched_clock() - start;
+#else
+	uint8_t last = SCHED_TCNTL;
+	uint16_t idle = 0;
+
+	while ((uint8_t)sched_tick == seen)
+	{
+		uint8_t now = SCHED_TCNTL;
+		uint8_t gap = now - last;
+
+		last = now;
+		if (gap <= SCHED_IDLE_GAP)
+			idle += gap;
+	}
+	sched_idle_counts += idle;
+#endif
+}
+
+uint8_t sched_load(void)
+{
+	return sched_load_percent;
+}
+
+uint32_t sched_ticks(void)
+{
+	uint32_t ticks;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ticks = sched_tick;
+	}
+	return ticks;
+}
+
+const SchedTask *sched_task(uint8_t id)
+{
+	return id < sched_count ? &sched_table[id] : 0;
+}
+
+void sched_clear_stats(void)
+{
+	for (uint8_t i = 0; i < sched_count; ++i)
+	{
+		SchedTask &task = sched_table[i];
+		task.runTime = task.maxRunTime = task.maxLateness = 0;
+		task.runs = task.overruns = 0;
+	}
+}
+
+
+ISR(SCHED_COMPARE_vect)
+{
+	LAT_BEGIN(LAT_SCHED_TICK);
+	SCHED_OCR += SCHED_COUNTS;
+	++sched_tick;
+	LAT_END(LAT_SCHED_TICK);
+}
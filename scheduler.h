@@ -0,0 +1,98 @@
+/*
+ * scheduler.h
+ *
+ * Created: 10/17/2026 5:12:08 PM
+ *  Author: Bibek Shrestha
+ *
+ * Fixed-rate cooperative scheduler. One hardware tick (Timer5 compare
+ * match, 1 ms) is the time base; each task has a period and an offset
+ * in ticks and is released at exact multiples of its period, so a slow
+ * iteration does not drift the rate.
+ *
+ * sched_run() runs at most one due task and returns; tasks are checked
+ * in the order they were added, so the first one added (control) starts
+ * at most one lower priority task late. Every task's run time and start
+ * lateness are measured off the tick timer with 0.5 us resolution.
+ *
+ * Timer5 runs free in normal mode and the compare register is moved on
+ * by one tick's worth of counts at every match, so TCNT5 doubles as a
+ * free-running 16 bit clock for anything else that needs timestamps
+ * (latency.h). Read it with interrupts off outside an ISR.
+ *
+ * The scheduler takes Timer5 whole: sched_init() clears TCCR5A, so the
+ * OC5A-C outputs (PL3-PL5) are disconnected and cannot drive a motor.
+ * board.h lists those pins as claimed.
+ *
+ * When nothing is due, sched_idle() waits for the next tick and counts
+ * the time it spent waiting; sched_load() is the busy share of the last
+ * SCHED_LOAD_WINDOW ticks. The idle wait spins on the timer and books
+ * any gap longer than one loop pass as busy, so ISRs that fire while
+ * idle count as load. With SCHED_IDLE_SLEEP it sleeps in SLEEP_MODE_IDLE
+ * instead; that saves the polling, but whatever runs during the sleep
+ * (the ISR that woke the CPU) is booked as idle, so read the load from
+ * a build without it.
+ */ 
+
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include <stdint.h>
+
+//Timer that provides the scheduler tick
+#define SCHED_TIMER_NUM		5			/* the registers below */
+#define SCHED_TCCRA			TCCR5A
+#define SCHED_TCCRB			TCCR5B
+#define SCHED_TCNT			TCNT5
+#define SCHED_TCNTL			TCNT5L
+#define SCHED_OCR			OCR5A
+#define SCHED_TIMSK			TIMSK5
+#define SCHED_OCIE			OCIE5A
+#define SCHED_TIFR			TIFR5
+#define SCHED_OCF			OCF5A
+#define SCHED_CLOCK			_BV(CS51)		/* clk/8, 0.5us per count */
+#define SCHED_COUNTS		2000			/* counts per tick, 1ms */
+#define SCHED_COUNTS_PER_US	2
+#define SCHED_COMPARE_vect	TIMER5_COMPA_vect
+
+#define SCHED_MAX_TASKS		6
+
+#define SCHED_LOAD_WINDOW	100			/* ticks per sched_load() figure */
+#define SCHED_IDLE_GAP		3			/* counts; longer idle loop passes were ISRs */
+
+#ifndef SCHED_IDLE_SLEEP
+#define SCHED_IDLE_SLEEP	0
+#endif
+
+struct SchedTask
+{
+	void	 (*run)(void);
+	uint16_t period;			/* ticks */
+	uint32_t due;				/* tick of the next release */
+
+	uint16_t runTime;			/* us, last run */
+	uint16_t maxRunTime;		/* us */
+	uint16_t maxLateness;		/* us from release to start */
+	uint16_t runs;
+	uint16_t overruns;			/* releases skipped because a whole period was missed */
+};
+
+void sched_init(void);
+
+/* returns the task id, or 0xFF when the table is full */
+uint8_t sched_add(void (*run)(void), uint16_t period, uint16_t offset);
+
+/* run the most urgent due task; returns 0 when nothing was due */
+uint8_t sched_run(void);
+
+/* wait for the next tick, counting the wait as idle time */
+void sched_idle(void);
+
+/* percent of the last load window not spent in sched_idle() */
+uint8_t sched_load(void);
+
+uint32_t sched_ticks(void);
+const SchedTask *sched_task(uint8_t id);
+void sched_clear_stats(void);
+
+#endif /* SCHEDULER_H_ */
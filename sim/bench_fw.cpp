@@ -0,0 +1,445 @@
+/*
+ * bench_fw.cpp
+ *
+ * Created: 10/17/2026 11:02:31 AM
+ *  Author: Bibek Shrestha
+ *
+ * Benchmark image for simbench. It links the real PID, UART, LCD,
+ * telemetry and scheduler code and runs the control, display and
+ * telemetry tasks of main() with span markers around each piece.
+ *
+ * The Motor/ and Magazine/ classes are not needed here: the ISR bodies
+ * below are the ones from main.cpp, run against stand-ins that carry only
+ * the fields those ISRs touch. Build app.elf instead to measure the real
+ * main() when those sources are present.
+ */ 
+
+
+#include "declarations.h"
+#include "PID.h"
+#include "simmark.h"
+#include "telemetry.h"
+#include "scheduler.h"
+#include "capture.h"
+#include "rpmfilter.h"
+#include "quadrature.h"
+#include "format.h"
+#include "board.h"
+#include "feedforward.h"
+
+#include <stdlib.h>
+
+
+struct SimMotor
+{
+	volatile uint16_t Count;
+	volatile bool     IntFlag;
+	volatile int      RPM;
+	int               Ocr;
+	PID               Controller;
+};
+
+struct SimEncoder
+{
+	volatile bool UpFlag;
+	volatile long Count;
+};
+
+SimMotor   BackMotor;
+SimMotor   FrontMotor;
+SimMotor   SideMotor;
+SimEncoder FrontEncoder;
+SimEncoder BackEncoder;
+
+#if MOTORBACK_CAPTURE
+CaptureChannel BackCapture;
+#endif
+#if MOTORFRONT_CAPTURE
+CaptureChannel FrontCapture;
+#endif
+#if SIDEMOTOR_CAPTURE
+CaptureChannel SideCapture;
+#endif
+
+static RpmFilter BackFilter;
+static RpmFilter FrontFilter;
+
+QuadDecoder FrontQuad;
+QuadDecoder BackQuad;
+
+
+static void motor_timer_init(void)
+{
+	/* normal mode, clk/64, overflow interrupt */
+	TCCR1B = _BV(CS11) | _BV(CS10);
+	TCCR3B = _BV(CS31) | _BV(CS30);
+	TCCR4B = _BV(CS41) | _BV(CS40);
+	TIMSK1 = _BV(TOIE1);
+	TIMSK3 = _BV(TOIE3);
+	TIMSK4 = _BV(TOIE4);
+
+	/* rising edge on the RPM and encoder A inputs */
+	MotorBackInt::rising_edge();
+	MotorFrontInt::rising_edge();
+	SideMotorInt::rising_edge();
+	EnFrontInt::rising_edge();
+	EnBackInt::rising_edge();
+
+	MotorBackInt::enable();
+	MotorFrontInt::enable();
+	SideMotorInt::enable();
+	EnFrontInt::enable();
+	EnBackInt::enable();
+}
+
+
+/* not static, so the conversions below cannot be optimised away */
+char format_buffer[12];
+
+/* decimal conversion, once per value at start-up: format.h against avr-libc */
+static void format_bench(void)
+{
+	static const int16_t values[] = { 0, 7, -230, 1500, 4095, 9999, -32768, 32767 };
+
+	for (uint8_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i)
+	{
+		int32_t wide = values[i] * 65537L;
+
+		FmtBuffer out16(format_buffer);
+		SIM_BEGIN(SIM_SPAN_FMT_I16);
+		fmt_i16(out16, values[i]);
+		SIM_END(SIM_SPAN_FMT_I16);
+
+		SIM_BEGIN(SIM_SPAN_ITOA);
+		itoa(values[i], format_buffer, 10);
+		SIM_END(SIM_SPAN_ITOA);
+
+		FmtBuffer out32(format_buffer);
+		SIM_BEGIN(SIM_SPAN_FMT_I32);
+		fmt_i32(out32, wide);
+		SIM_END(SIM_SPAN_FMT_I32);
+
+		SIM_BEGIN(SIM_SPAN_LTOA);
+		ltoa(wide, format_buffer, 10);
+		SIM_END(SIM_SPAN_LTOA);
+	}
+}
+
+
+/* not static either; SIM_VALUE is taken by the RPM count */
+int16_t ff_result;
+
+/* feed-forward lookup, once per setpoint change on the board */
+static void ff_bench(void)
+{
+	static const int16_t rpms[] = { 0, 250, 500, 1234, 1500, 2750, 4000, 5000 };
+
+	for (uint8_t i = 0; i < sizeof(rpms) / sizeof(rpms[0]); ++i)
+	{
+		SIM_BEGIN(SIM_SPAN_FF_LOOKUP);
+		ff_result = ff_lookup(rpms[i]);
+		SIM_END(SIM_SPAN_FF_LOOKUP);
+	}
+}
+
+
+static void control_task(void)
+{
+	SIM_BEGIN(SIM_SPAN_CONTROL);
+
+	if(BackMotor.IntFlag)
+	{
+		BackMotor.IntFlag = false;
+		BackMotor.RPM = BackMotor.Count;
+		SIM_VALUE(BackMotor.Count);
+	}
+
+	SIM_BEGIN(SIM_SPAN_PID);
+	BackMotor.Ocr = BackMotor.Controller.Compute_PID(BackMotor.RPM, false);
+	SIM_END(SIM_SPAN_PID);
+	//as in main.cpp, the front motor follows the back PID
+	FrontMotor.Ocr = BackMotor.Ocr;
+
+	SIM_END(SIM_SPAN_CONTROL);
+}
+
+static void command_task(void)
+{
+	if(uart3_available())
+		uart3_getc();
+}
+
+static void telemetry_task(void)
+{
+	TelemetrySample sample;
+	sample.timestamp     = sched_ticks();
+	sample.running       = false;
+	sample.position      = HOMEPOSITION;
+	sample.backRPM       = BackMotor.RPM;
+	sample.backSetpoint  = BackMotor.Controller.setpoint;
+	sample.backOcr       = BackMotor.Ocr;
+	sample.frontRPM      = FrontMotor.RPM;
+	sample.frontSetpoint = FrontMotor.Controller.setpoint;
+	sample.frontOcr      = FrontMotor.Ocr;
+	sample.sideRPM       = SideMotor.RPM;
+	sample.sideOcr       = SideMotor.Ocr;
+	sample.load          = sched_load();
+
+	SIM_BEGIN(SIM_SPAN_TELEMETRY);
+	telemetry_send(sample);
+	SIM_END(SIM_SPAN_TELEMETRY);
+}
+
+static void display_task(void)
+{
+	lcd_fb_gotoxy(0,0);
+	SIM_BEGIN(SIM_SPAN_LCD_NUM);
+	lcd_fb_num(BackMotor.Controller.setpoint);
+	SIM_END(SIM_SPAN_LCD_NUM);
+	lcd_fb_putch(' ');
+	lcd_fb_num(BackMotor.RPM);
+
+	lcd_fb_gotoxy(0,1);
+	lcd_fb_num(HOMEPOSITION);
+	lcd_fb_putch(' ');
+	lcd_fb_num(NOTGOINGANYWHERE);
+	lcd_fb_putch(' ');
+	lcd_fb_num(SideMotor.Ocr);
+}
+
+
+int main(void)
+{
+	initialise();
+	format_bench();
+	ff_init();
+	ff_bench();
+	motor_timer_init();
+	capture_init();
+	quad_init(FrontQuad, BackQuad);
+
+	BackMotor.Controller.Initialise();
+	FrontMotor.Controller.Initialise();
+	BackMotor.Controller.Set_PID(1.07, 0.0135, 23.87);
+#if PID_GAIN_SCHEDULE
+	BackMotor.Controller.Use_Schedule();
+#endif
+#if PID_FEED_FORWARD
+	BackMotor.Controller.Use_Feed_Forward(true);
+#endif
+#if PID_TRAJECTORY
+	BackMotor.Controller.Use_Trajectory(PID_TRAJ_RATE, PID_TRAJ_ACCEL);
+#endif
+
+	sched_init();
+	sched_add(control_task,   4,   0);
+	sched_add(command_task,   1,   0);
+	sched_add(telemetry_task, 10,  1);
+	sched_add(display_task,   100, 2);
+
+	sei();
+
+	while(1)
+	{
+		if(!sched_run())
+			sched_idle();
+	}
+}
+
+
+#if MOTORBACK_CAPTURE
+
+ISR(MOTORBACK_CAPT_vect)
+{
+	uint16_t icr = MotorBackTimer::icr();
+	bool wrapped = (MotorBackTimer::tifr() & _BV(MotorBackTimer::Tov)) && icr < 0x8000;
+	if(wrapped)
+		MotorBackTimer::tifr() = _BV(MotorBackTimer::Tov);
+
+	uint32_t period = capture_edge(BackCapture, icr, wrapped);
+	if(period)
+	{
+		BackMotor.Count   = rpm_filter_step(BackFilter, capture_count(period));
+		BackMotor.IntFlag = true;
+	}
+}
+
+
+ISR(MOTORBACK_TIMER_OVERFLOW_VECT)
+{
+	if(capture_overflow(BackCapture))
+	{
+		BackMotor.RPM = 0;
+		rpm_filter_reset(BackFilter);
+	}
+}
+
+#else
+
+ISR(MOTORBACK_INT_vect)
+{
+	uint16_t count = MotorBackTimer::tcnt();
+	MotorBackTimer::tcnt() = 0;
+	BackMotor.Count   = rpm_filter_step(BackFilter, count);
+	BackMotor.IntFlag = true;
+}
+
+
+ISR(MOTORBACK_TIMER_OVERFLOW_VECT)
+{
+	BackMotor.RPM = 0;
+	rpm_filter_reset(BackFilter);
+}
+
+#endif
+
+#if SIDEMOTOR_CAPTURE
+
+ISR(SIDEMOTOR_CAPT_vect)
+{
+	uint16_t icr = SideMotorTimer::icr();
+	bool wrapped = (SideMotorTimer::tifr() & _BV(SideMotorTimer::Tov)) && icr < 0x8000;
+	if(wrapped)
+		SideMotorTimer::tifr() = _BV(SideMotorTimer::Tov);
+
+	uint32_t period = capture_edge(SideCapture, icr, wrapped);
+	if(period)
+	{
+		SideMotor.Count   = capture_count(period);
+		SideMotor.IntFlag = true;
+	}
+}
+
+
+ISR(SIDEMOTOR_TIMER_OVERFLOW_VECT)
+{
+	capture_overflow(SideCapture);
+	//SideMotor.RPM = 0;
+}
+
+#else
+
+ISR(SIDEMOTOR_INT_vect)
+{
+	SideMotor.Count   = SideMotorTimer::tcnt();
+	SideMotorTimer::tcnt() = 0;
+	SideMotor.IntFlag = true;
+}
+
+
+ISR(SIDEMOTOR_TIMER_OVERFLOW_VECT)
+{
+	//SideMotor.RPM = 0;
+}
+
+#endif
+
+
+#if MOTORFRONT_CAPTURE
+
+ISR(MOTORFRONT_CAPT_vect)
+{
+	uint16_t icr = MotorFrontTimer::icr();
+	bool wrapped = (MotorFrontTimer::tifr() & _BV(MotorFrontTimer::Tov)) && icr < 0x8000;
+	if(wrapped)
+		MotorFrontTimer::tifr() = _BV(MotorFrontTimer::Tov);
+
+	uint32_t period = capture_edge(FrontCapture, icr, wrapped);
+	if(period)
+	{
+		FrontMotor.Count   = rpm_filter_step(FrontFilter, capture_count(period));
+		FrontMotor.IntFlag = true;
+	}
+}
+
+
+ISR(MOTORFRONT_TIMER_OVERFLOW_VECT)
+{
+	if(capture_overflow(FrontCapture))
+	{
+		FrontMotor.RPM = 0;
+		rpm_filter_reset(FrontFilter);
+	}
+}
+
+#else
+
+ISR(MOTORFRONT_TIMER_OVERFLOW_VECT)
+{
+	FrontMotor.RPM = 0;
+	rpm_filter_reset(FrontFilter);
+}
+
+
+ISR(MOTORFRONT_INT_vect)
+{
+	uint16_t count = MotorFrontTimer::tcnt();
+	MotorFrontTimer::tcnt() = 0;
+	FrontMotor.Count   = rpm_filter_step(FrontFilter, count);
+	FrontMotor.IntFlag = true;
+}
+
+#endif
+
+
+ISR(PID_TIMER_OVERFLOW_vect)
+{
+	++BackMotor.Controller.timer;
+	++FrontMotor.Controller.timer;
+}
+
+
+template <class E>
+static inline void EncoderMove(E &encoder, int8_t step)
+{
+	if(step > 0)
+	{
+		encoder.UpFlag = true;
+		++encoder.Count;
+	}
+	else if(step < 0)
+	{
+		encoder.UpFlag = false;
+		--encoder.Count;
+	}
+}
+
+
+ISR(EN_FRONT_INT_vect)
+{
+#if EN_FRONT_4X
+	int8_t edge = quad_step(FrontQuad, en_front_ab());
+#else
+	int8_t edge = quad_step_a(FrontQuad, en_front_ab());
+#endif
+	EncoderMove(FrontEncoder, quad_count(FrontQuad, edge, EN_FRONT_EDGES));
+}
+
+
+ISR(EN_BACK_INT_vect)
+{	
+#if EN_BACK_4X
+	int8_t edge = quad_step(BackQuad, en_back_ab());
+#else
+	int8_t edge = quad_step_a(BackQuad, en_back_ab());
+#endif
+	EncoderMove(BackEncoder, quad_count(BackQuad, edge, EN_BACK_EDGES));
+}
+
+
+#if EN_FRONT_4X || EN_BACK_4X
+
+/* B channels; a decoder whose pins did not change steps by 0 */
+ISR(EN_B4X_PCINT_vect)
+{
+#if EN_FRONT_4X
+	EncoderMove(FrontEncoder,
+				quad_count(FrontQuad, quad_step(FrontQuad, en_front_ab()), EN_FRONT_EDGES));
+#endif
+#if EN_BACK_4X
+	EncoderMove(BackEncoder,
+				quad_count(BackQuad, quad_step(BackQuad, en_back_ab()), EN_BACK_EDGES));
+#endif
+}
+
+#endif
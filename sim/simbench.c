@@ -0,0 +1,417 @@
+/*
+ * simbench.c
+ *
+ * Created: 10/17/2026 11:02:31 AM
+ *  Author: Bibek Shrestha
+ *
+ * Cycle accurate benchmark harness for the ATmega2560 image under simavr.
+ *
+ * The firmware is stepped one instruction at a time. An ISR starts when
+ * the core lands on its vector and ends at the matching RETI, so every
+ * interrupt is timed without touching the source. Code spans are timed
+ * from the SIM_BEGIN/SIM_END markers in simmark.h, which write the span
+ * id to GPIOR1/GPIOR2.
+ *
+ * While running, the harness feeds the firmware RPM edges on INT2/INT3/
+ * INT0, quadrature encoder edges on INT4/INT5 and bytes on USART0 and
+ * USART3. The RPM edges are also driven onto ICP3/ICP1/ICP4 for images
+ * built with input capture, and the encoder B channels onto PK0/PK1 for
+ * images built with 4x quadrature decoding. Results are printed as one
+ * "key=value" line per source:
+ *
+ *   sim=<name> kind=<isr|span> count=<n> min=<cyc> mean=<cyc> max=<cyc>
+ *   sim=sample kind=value count=<n> min=<v> mean=<v> max=<v>   (SIM_VALUE)
+ *
+ * For the encoder interrupts the highest edge rate they can keep up with
+ * is printed as well:
+ *
+ *   sim=<name> kind=edge_rate max_hz=<F_CPU / (max cycles + 5)>
+ */
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "sim_avr.h"
+#include "sim_elf.h"
+#include "sim_irq.h"
+#include "sim_cycle_timers.h"
+#include "avr_ioport.h"
+#include "avr_uart.h"
+
+
+#define GPIOR0_ADDR		0x3E
+#define GPIOR1_ADDR		0x4A
+#define GPIOR2_ADDR		0x4B
+#define RETI_OPCODE		0x9518
+#define VECTOR_SIZE		4			/* bytes per vector on the 2560 */
+#define VECTOR_COUNT	57
+#define SPAN_COUNT		32
+#define NEST_DEPTH		8
+
+
+typedef struct
+{
+	uint64_t count;
+	uint64_t total;
+	uint64_t min;
+	uint64_t max;
+} stat_t;
+
+static void stat_add(stat_t *s, uint64_t cycles)
+{
+	if (!s->count || cycles < s->min)
+		s->min = cycles;
+	if (cycles > s->max)
+		s->max = cycles;
+	s->total += cycles;
+	++s->count;
+}
+
+static void stat_print(const char *name, const char *kind, const stat_t *s)
+{
+	if (!s->count)
+		return;
+	printf("sim=%s kind=%s count=%llu min=%llu mean=%llu max=%llu\n",
+		   name, kind,
+		   (unsigned long long)s->count,
+		   (unsigned long long)s->min,
+		   (unsigned long long)(s->total / s->count),
+		   (unsigned long long)s->max);
+}
+
+
+static const char *vector_name[VECTOR_COUNT] =
+{
+	[1]  = "INT0_SIDEMOTOR",
+	[3]  = "INT2_MOTORBACK",
+	[4]  = "INT3_MOTORFRONT",
+	[5]  = "INT4_EN_BACK",
+	[6]  = "INT5_EN_FRONT",
+	[11] = "PCINT2_EN_B4X",
+	[13] = "TIMER2_COMPA_LCD",
+	[16] = "TIMER1_CAPT",
+	[20] = "TIMER1_OVF",
+	[23] = "TIMER0_OVF_PID",
+	[25] = "USART0_RX",
+	[26] = "USART0_UDRE",
+	[31] = "TIMER3_CAPT",
+	[35] = "TIMER3_OVF",
+	[41] = "TIMER4_CAPT",
+	[45] = "TIMER4_OVF",
+	[47] = "TIMER5_COMPA_SCHED",
+	[54] = "USART3_RX",
+	[55] = "USART3_UDRE",
+};
+
+static const char *span_name[SPAN_COUNT] =
+{
+	[1] = "control",
+	[2] = "uart0_putint",
+	[3] = "lcd_num",
+	[4] = "pid_compute",
+	[5] = "telemetry_send",
+	[6] = "fmt_i16",
+	[7] = "itoa",
+	[8] = "fmt_i32",
+	[9] = "ltoa",
+	[10] = "ff_lookup",
+};
+
+
+static stat_t isr_stat[VECTOR_COUNT];
+static stat_t span_stat[SPAN_COUNT];
+static uint64_t span_start[SPAN_COUNT];
+static stat_t value_stat;
+static int value_low = -1;
+
+static struct
+{
+	int      vector;
+	uint64_t start;
+} nest[NEST_DEPTH];
+static int nest_depth;
+
+static uint64_t uart0_tx_bytes;
+
+
+/* stimulus settings */
+static uint32_t back_rpm  = 1500;
+static uint32_t front_rpm = 1500;
+static uint32_t side_rpm  = 600;
+static uint32_t pulses_per_rev = 1;
+static uint32_t encoder_hz = 2000;
+static uint32_t uart_bytes_per_s = 20;
+
+
+static void span_begin(struct avr_t *avr, avr_io_addr_t addr, uint8_t v, void *param)
+{
+	(void)addr; (void)param;
+	if (v < SPAN_COUNT)
+		span_start[v] = avr->cycle;
+}
+
+static void span_end(struct avr_t *avr, avr_io_addr_t addr, uint8_t v, void *param)
+{
+	(void)addr; (void)param;
+	if (v < SPAN_COUNT && span_start[v])
+		stat_add(&span_stat[v], avr->cycle - span_start[v]);
+}
+
+static void value_byte(struct avr_t *avr, avr_io_addr_t addr, uint8_t v, void *param)
+{
+	(void)avr; (void)addr; (void)param;
+	if (value_low < 0)
+	{
+		value_low = v;
+		return;
+	}
+	stat_add(&value_stat, (uint64_t)(value_low | (v << 8)));
+	value_low = -1;
+}
+
+static void uart0_output(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+	(void)irq; (void)value; (void)param;
+	++uart0_tx_bytes;
+}
+
+
+/* square wave on one port pin, half a period per callback */
+typedef struct
+{
+	avr_irq_t *irq;
+	avr_irq_t *icp;				/* same signal on the input capture pin */
+	avr_cycle_count_t half_period;
+	uint8_t level;
+} edge_source_t;
+
+static avr_cycle_count_t edge_tick(struct avr_t *avr, avr_cycle_count_t when, void *param)
+{
+	edge_source_t *src = (edge_source_t *)param;
+	(void)avr;
+
+	src->level = !src->level;
+	avr_raise_irq(src->irq, src->level);
+	avr_raise_irq(src->icp, src->level);
+	return when + src->half_period;
+}
+
+static void edge_start(avr_t *avr, edge_source_t *src, char port, int pin,
+					   char icp_port, int icp_pin, uint32_t hz)
+{
+	if (!hz)
+		return;
+	src->irq = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(port), pin);
+	src->icp = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(icp_port), icp_pin);
+	src->half_period = avr->frequency / (2 * hz);
+	src->level = 0;
+	avr_cycle_timer_register(avr, src->half_period, edge_tick, src);
+}
+
+
+/* quadrature pair: B lags A by a quarter period */
+typedef struct
+{
+	avr_irq_t *a;
+	avr_irq_t *b;
+	avr_irq_t *b4x;				/* B again on its pin change input */
+	avr_cycle_count_t quarter_period;
+	uint8_t phase;
+} quad_source_t;
+
+static avr_cycle_count_t quad_tick(struct avr_t *avr, avr_cycle_count_t when, void *param)
+{
+	static const uint8_t gray[4] = { 0, 1, 3, 2 };
+	quad_source_t *src = (quad_source_t *)param;
+	(void)avr;
+
+	src->phase = (src->phase + 1) & 3;
+	avr_raise_irq(src->a, gray[src->phase] & 1);
+	avr_raise_irq(src->b, gray[src->phase] >> 1);
+	avr_raise_irq(src->b4x, gray[src->phase] >> 1);
+	return when + src->quarter_period;
+}
+
+static void quad_start(avr_t *avr, quad_source_t *src,
+					   char port_a, int pin_a, char port_b, int pin_b, int pin_b4x, uint32_t hz)
+{
+	if (!hz)
+		return;
+	src->a = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(port_a), pin_a);
+	src->b = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(port_b), pin_b);
+	src->b4x = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('K'), pin_b4x);
+	src->quarter_period = avr->frequency / (4 * hz);
+	src->phase = 0;
+	avr_cycle_timer_register(avr, src->quarter_period, quad_tick, src);
+}
+
+
+/* command bytes on a UART, cycling through the ones main() understands */
+typedef struct
+{
+	avr_irq_t *irq;
+	avr_cycle_count_t period;
+	uint8_t index;
+} uart_source_t;
+
+static avr_cycle_count_t uart_tick(struct avr_t *avr, avr_cycle_count_t when, void *param)
+{
+	static const uint8_t commands[] = { 'g', 'a', 'z', 's', 'd', 'D' };
+	uart_source_t *src = (uart_source_t *)param;
+	(void)avr;
+
+	avr_raise_irq(src->irq, commands[src->index]);
+	src->index = (src->index + 1) % sizeof(commands);
+	return when + src->period;
+}
+
+static void uart_start(avr_t *avr, uart_source_t *src, char uart, uint32_t bytes_per_s)
+{
+	uint32_t flags = 0;
+
+	avr_ioctl(avr, AVR_IOCTL_UART_GET_FLAGS(uart), &flags);
+	flags &= ~AVR_UART_FLAG_STDIO;
+	avr_ioctl(avr, AVR_IOCTL_UART_SET_FLAGS(uart), &flags);
+
+	if (!bytes_per_s)
+		return;
+	src->irq = avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ(uart), UART_IRQ_INPUT);
+	src->period = avr->frequency / bytes_per_s;
+	src->index = 0;
+	avr_cycle_timer_register(avr, src->period, uart_tick, src);
+}
+
+
+static uint32_t rpm_to_hz(uint32_t rpm)
+{
+	return rpm * pulses_per_rev / 60;
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr,
+		"usage: %s [-m ms] [-b rpm] [-f rpm] [-s rpm] [-p pulses/rev]\n"
+		"          [-e encoder_hz] [-u uart_bytes/s] firmware.elf\n", prog);
+	exit(2);
+}
+
+
+int main(int argc, char *argv[])
+{
+	uint32_t run_ms = 1000;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "m:b:f:s:p:e:u:")) != -1)
+	{
+		switch (opt)
+		{
+			case 'm': run_ms = strtoul(optarg, NULL, 0); break;
+			case 'b': back_rpm = strtoul(optarg, NULL, 0); break;
+			case 'f': front_rpm = strtoul(optarg, NULL, 0); break;
+			case 's': side_rpm = strtoul(optarg, NULL, 0); break;
+			case 'p': pulses_per_rev = strtoul(optarg, NULL, 0); break;
+			case 'e': encoder_hz = strtoul(optarg, NULL, 0); break;
+			case 'u': uart_bytes_per_s = strtoul(optarg, NULL, 0); break;
+			default: usage(argv[0]);
+		}
+	}
+	if (optind != argc - 1)
+		usage(argv[0]);
+
+	elf_firmware_t firmware;
+	memset(&firmware, 0, sizeof(firmware));
+	if (elf_read_firmware(argv[optind], &firmware) != 0)
+	{
+		fprintf(stderr, "simbench: cannot read %s\n", argv[optind]);
+		return 1;
+	}
+
+	avr_t *avr = avr_make_mcu_by_name("atmega2560");
+	if (!avr)
+	{
+		fprintf(stderr, "simbench: simavr has no atmega2560 core\n");
+		return 1;
+	}
+	avr_init(avr);
+	avr->frequency = 16000000;
+	avr_load_firmware(avr, &firmware);
+	avr->log = LOG_ERROR;
+
+	avr_register_io_write(avr, GPIOR0_ADDR, value_byte, NULL);
+	avr_register_io_write(avr, GPIOR1_ADDR, span_begin, NULL);
+	avr_register_io_write(avr, GPIOR2_ADDR, span_end, NULL);
+	avr_irq_register_notify(
+		avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUTPUT),
+		uart0_output, NULL);
+
+	edge_source_t back, front, side;
+	quad_source_t enc_front, enc_back;
+	uart_source_t uart0, uart3;
+
+	edge_start(avr, &back,  'D', 2, 'E', 7, rpm_to_hz(back_rpm));
+	edge_start(avr, &front, 'D', 3, 'D', 4, rpm_to_hz(front_rpm));
+	edge_start(avr, &side,  'D', 0, 'L', 0, rpm_to_hz(side_rpm));
+	quad_start(avr, &enc_front, 'E', 5, 'E', 3, 0, encoder_hz);
+	quad_start(avr, &enc_back,  'E', 4, 'H', 3, 1, encoder_hz);
+	uart_start(avr, &uart0, '0', 0);
+	uart_start(avr, &uart3, '3', uart_bytes_per_s);
+
+	avr_cycle_count_t limit = (avr_cycle_count_t)run_ms * (avr->frequency / 1000);
+
+	while (avr->cycle < limit)
+	{
+		avr_flashaddr_t pc = avr->pc;
+		int reti = (avr->flash[pc] | (avr->flash[pc + 1] << 8)) == RETI_OPCODE;
+
+		int state = avr_run(avr);
+		if (state == cpu_Done || state == cpu_Crashed)
+		{
+			fprintf(stderr, "simbench: core stopped (state %d) at pc 0x%05x\n", state, pc);
+			break;
+		}
+
+		if (reti && nest_depth)
+		{
+			--nest_depth;
+			stat_add(&isr_stat[nest[nest_depth].vector],
+					 avr->cycle - nest[nest_depth].start);
+		}
+
+		/* landing on a vector other than reset means an interrupt was taken */
+		if (avr->pc && avr->pc < VECTOR_COUNT * VECTOR_SIZE && !(avr->pc % VECTOR_SIZE)
+			&& nest_depth < NEST_DEPTH)
+		{
+			nest[nest_depth].vector = avr->pc / VECTOR_SIZE;
+			nest[nest_depth].start = avr->cycle;
+			++nest_depth;
+		}
+	}
+
+	for (int v = 0; v < VECTOR_COUNT; ++v)
+	{
+		char name[16];
+		if (!vector_name[v])
+			snprintf(name, sizeof(name), "vector%d", v);
+		stat_print(vector_name[v] ? vector_name[v] : name, "isr", &isr_stat[v]);
+		if ((v == 5 || v == 6 || v == 11) && isr_stat[v].count)
+			printf("sim=%s kind=edge_rate max_hz=%llu\n", vector_name[v],
+				   (unsigned long long)(avr->frequency / (isr_stat[v].max + 5)));
+	}
+	for (int s = 0; s < SPAN_COUNT; ++s)
+	{
+		char name[16];
+		if (!span_name[s])
+			snprintf(name, sizeof(name), "span%d", s);
+		stat_print(span_name[s] ? span_name[s] : name, "span", &span_stat[s]);
+	}
+	stat_print("sample", "value", &value_stat);
+	printf("sim=run kind=total cycles=%llu uart0_tx_bytes=%llu\n",
+		   (unsigned long long)avr->cycle, (unsigned long long)uart0_tx_bytes);
+
+	avr_terminate(avr);
+	return 0;
+}
@@ -0,0 +1,41 @@
+/*
+ * simmark.h
+ *
+ * Created: 10/17/2026 11:02:31 AM
+ *  Author: Bibek Shrestha
+ *
+ * Span markers for the simavr benchmark harness (sim/). With SIM_BENCH
+ * defined each marker is a single OUT to a general purpose I/O register,
+ * which the harness timestamps with the simulated cycle counter. In the
+ * normal build they compile to nothing.
+ *
+ * SIM_VALUE hands a 16 bit sample to the harness through GPIOR0, low byte
+ * first, for min/mean/max of a measured quantity.
+ */ 
+
+
+#ifndef SIMMARK_H_
+#define SIMMARK_H_
+
+#define SIM_SPAN_CONTROL		1		/* control task */
+#define SIM_SPAN_UART0_PUTINT	2
+#define SIM_SPAN_LCD_NUM		3
+#define SIM_SPAN_PID			4
+#define SIM_SPAN_TELEMETRY		5
+#define SIM_SPAN_FMT_I16		6		/* format.h against avr-libc */
+#define SIM_SPAN_ITOA			7
+#define SIM_SPAN_FMT_I32		8
+#define SIM_SPAN_LTOA			9
+#define SIM_SPAN_FF_LOOKUP		10		/* feed-forward table interpolation */
+
+#ifdef SIM_BENCH
+#define SIM_BEGIN(span)		(GPIOR1 = (span))
+#define SIM_END(span)		(GPIOR2 = (span))
+#define SIM_VALUE(v)		do { uint16_t sim_v = (v); GPIOR0 = (uint8_t)sim_v; GPIOR0 = (uint8_t)(sim_v >> 8); } while (0)
+#else
+#define SIM_BEGIN(span)
+#define SIM_END(span)
+#define SIM_VALUE(v)
+#endif
+
+#endif /* SIMMARK_H_ */
@@ -0,0 +1,134 @@
+/*
+ * telemetry.cpp
+ *
+ * Created: 10/17/2026 3:05:44 PM
+ *  Author: Bibek Shrestha
+ */ 
+
+
+#include <avr/io.h>
+
+#include "telemetry.h"
+#include "frame.h"
+#include "trace.h"
+#include "uart.h"
+#include "format.h"
+
+
+static uint8_t telemetry_sequence;
+
+
+static uint16_t unsigned12(int16_t value)
+{
+	if (value < 0)
+		return 0;
+	if (value > 0x0FFF)
+		return 0x0FFF;
+	return value;
+}
+
+static uint16_t signed12(int16_t value)
+{
+	if (value < -2048)
+		value = -2048;
+	else if (value > 2047)
+		value = 2047;
+	return (uint16_t)value & 0x0FFF;
+}
+
+static uint8_t *pack12(uint8_t *p, uint16_t a, uint16_t b)
+{
+	*p++ = (uint8_t)a;
+	*p++ = (uint8_t)((a >> 8) | (b << 4));
+	*p++ = (uint8_t)(b >> 4);
+	return p;
+}
+
+
+uint8_t telemetry_encode(const TelemetrySample &sample, uint8_t sequence, uint8_t *frame)
+{
+	uint8_t record[TELEMETRY_PAYLOAD_SIZE + 1];
+	uint8_t *p = record;
+
+	*p++ = (TELEMETRY_RECORD_SAMPLE << 5) | (sample.running ? 0x10 : 0) | (sample.position & 0x0F);
+	*p++ = sequence;
+	*p++ = (uint8_t)sample.timestamp;
+	*p++ = (uint8_t)(sample.timestamp >> 8);
+	p = pack12(p, unsigned12(sample.backRPM), unsigned12(sample.backSetpoint));
+	p = pack12(p, signed12(sample.backOcr), unsigned12(sample.frontRPM));
+	p = pack12(p, unsigned12(sample.frontSetpoint), signed12(sample.frontOcr));
+	p = pack12(p, unsigned12(sample.sideRPM), signed12(sample.sideOcr));
+	*p++ = sample.load;
+
+	return frame_seal(record, TELEMETRY_PAYLOAD_SIZE, frame);
+}
+
+uint8_t telemetry_encode_trace(const TraceSample &sample, uint8_t index, bool trigger, uint8_t *frame)
+{
+	uint8_t record[TELEMETRY_TRACE_PAYLOAD + 1];
+	uint8_t *p = record;
+
+	*p++ = (TELEMETRY_RECORD_TRACE << 5) | (trigger ? 0x10 : 0) | (sample.position & 0x0F);
+	*p++ = index;
+	*p++ = (uint8_t)sample.timestamp;
+	*p++ = (uint8_t)(sample.timestamp >> 8);
+	p = pack12(p, unsigned12(sample.backRPM), unsigned12(sample.backSetpoint));
+	p = pack12(p, signed12(sample.backOcr), unsigned12(sample.frontRPM));
+	p = pack12(p, unsigned12(sample.frontSetpoint), signed12(sample.frontOcr));
+
+	return frame_seal(record, TELEMETRY_TRACE_PAYLOAD, frame);
+}
+
+uint8_t telemetry_encode_trace_head(uint8_t reason, uint8_t capture, uint16_t timestamp,
+									uint8_t count, uint8_t trigger, uint8_t *frame)
+{
+	uint8_t record[TELEMETRY_TRACE_HEAD_PAYLOAD + 1];
+
+	record[0] = (TELEMETRY_RECORD_TRACE_HEAD << 5) | (reason & 0x1F);
+	record[1] = capture;
+	record[2] = (uint8_t)timestamp;
+	record[3] = (uint8_t)(timestamp >> 8);
+	record[4] = count;
+	record[5] = trigger;
+
+	return frame_seal(record, TELEMETRY_TRACE_HEAD_PAYLOAD, frame);
+}
+
+
+#if TELEMETRY_BINARY
+
+void telemetry_send(const TelemetrySample &sample)
+{
+	uint8_t frame[TELEMETRY_FRAME_SIZE];
+	uint8_t len = telemetry_encode(sample, telemetry_sequence++, frame);
+	uart0_try_putbuf(frame, len);
+}
+
+#else
+
+static void put_field(FmtBuffer &out, int16_t value)
+{
+	out.put(' ');
+	fmt_i16(out, value);
+}
+
+void telemetry_send(const TelemetrySample &sample)
+{
+	char line[TELEMETRY_ASCII_SIZE];
+	FmtBuffer out(line);
+
+	out.put(sample.running ? '2' : '1');
+	put_field(out, sample.backRPM);
+	put_field(out, sample.backSetpoint);
+	put_field(out, sample.backOcr);
+	put_field(out, sample.frontRPM);
+	put_field(out, sample.frontSetpoint);
+	put_field(out, sample.frontOcr);
+	out.put('\n');
+	out.put('\r');
+
+	uart0_try_putbuf((const uint8_t *)line, out.p - line);
+	++telemetry_sequence;
+}
+
+#endif /* TELEMETRY_BINARY */
@@ -0,0 +1,98 @@
+/*
+ * telemetry.h
+ *
+ * Created: 10/17/2026 3:05:44 PM
+ *  Author: Bibek Shrestha
+ *
+ * Per-iteration motor telemetry on uart0.
+ *
+ * With TELEMETRY_BINARY (default) every sample is one COBS framed record,
+ * 0x00 terminated, handed to the TX ring in a single uart0_try_putbuf(),
+ * which drops the whole record if the ring has no room for it:
+ *
+ *   byte  0      type << 5 | running << 4 | ThrowMotor.Position (4 bit)
+ *   byte  1      sequence number, +1 per record
+ *   bytes 2-3    timestamp, little endian, scheduler ticks (1 ms)
+ *   bytes 4-15   eight 12 bit fields, two per 3 bytes, low field first:
+ *                back RPM, back setpoint, back Ocr,
+ *                front RPM, front setpoint, front Ocr,
+ *                side RPM, side Ocr
+ *                RPM/setpoint are unsigned 0..4095, Ocr signed -2048..2047,
+ *                all saturated
+ *   byte  16     CPU load, percent (sched_load())
+ *   byte  17     CRC-8 (poly 0x07, init 0) of bytes 0-16
+ *
+ * That is 20 bytes on the wire against 33 for the ASCII line, which
+ * carries neither the side motor, sequence, time nor a check.
+ * TELEMETRY_BINARY 0 keeps the "1 RPM setpoint Ocr RPM setpoint Ocr\n\r"
+ * text format.
+ *
+ * Throw captures (trace.h) are always sent as binary frames of the same
+ * framing: one header record, then the samples oldest first.
+ *
+ *   header (record type 3), 6 payload bytes + CRC
+ *   byte  0      type << 5 | trigger reason (TRACE_TRIGGER_xxx)
+ *   byte  1      capture number, +1 per capture
+ *   bytes 2-3    timestamp of the trigger sample, ticks
+ *   byte  4      samples that follow
+ *   byte  5      index of the trigger sample, = pre-trigger samples
+ *   byte  6      CRC-8
+ *
+ *   sample (record type 2), 13 payload bytes + CRC
+ *   byte  0      type << 5 | trigger sample << 4 | ThrowMotor.Position
+ *   byte  1      index in the capture, 0 = oldest
+ *   bytes 2-3    timestamp, ticks
+ *   bytes 4-12   six 12 bit fields as above: back RPM, back setpoint,
+ *                back Ocr, front RPM, front setpoint, front Ocr
+ *   byte  13     CRC-8
+ *
+ * Either way a record goes to the TX ring whole or not at all and
+ * telemetry_send() never waits for the line; uart0_tx_dropped() counts
+ * the records that found the ring full. The sequence number advances for
+ * dropped records too, so the receiver sees the gaps.
+ */ 
+
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdint.h>
+
+#ifndef TELEMETRY_BINARY
+#define TELEMETRY_BINARY	1
+#endif
+
+#define TELEMETRY_RECORD_SAMPLE		1
+#define TELEMETRY_RECORD_TRACE		2
+#define TELEMETRY_RECORD_TRACE_HEAD	3
+
+#define TELEMETRY_PAYLOAD_SIZE		17
+#define TELEMETRY_FRAME_SIZE		(TELEMETRY_PAYLOAD_SIZE + 3)	/* CRC, COBS code, 0x00 */
+#define TELEMETRY_TRACE_PAYLOAD		13
+#define TELEMETRY_TRACE_HEAD_PAYLOAD	6
+#define TELEMETRY_TRACE_FRAME_SIZE	(TELEMETRY_TRACE_PAYLOAD + 3)
+#define TELEMETRY_ASCII_SIZE		(1 + 6 * 7 + 2)					/* six " -32768" fields */
+
+struct TelemetrySample
+{
+	uint16_t timestamp;
+	bool     running;
+	uint8_t  position;
+	int16_t  backRPM, backSetpoint, backOcr;
+	int16_t  frontRPM, frontSetpoint, frontOcr;
+	int16_t  sideRPM, sideOcr;
+	uint8_t  load;
+};
+
+void telemetry_send(const TelemetrySample &sample);
+
+/* frame encoder, exposed for the host tools; returns bytes written */
+uint8_t telemetry_encode(const TelemetrySample &sample, uint8_t sequence, uint8_t *frame);
+
+/* capture records (trace.h); frames are up to TELEMETRY_TRACE_FRAME_SIZE */
+struct TraceSample;
+uint8_t telemetry_encode_trace(const TraceSample &sample, uint8_t index, bool trigger, uint8_t *frame);
+uint8_t telemetry_encode_trace_head(uint8_t reason, uint8_t capture, uint16_t timestamp,
+									uint8_t count, uint8_t trigger, uint8_t *frame);
+
+#endif /* TELEMETRY_H_ */
@@ -0,0 +1,120 @@
+/*
+ * trace.cpp
+ *
+ * Created: 10/17/2026 11:20:36 PM
+ *  Author: Bibek Shrestha
+ */
+
+
+#include <avr/io.h>
+
+#include "trace.h"
+#include "telemetry.h"
+#include "uart.h"
+
+#define TRACE_MASK		(TRACE_DEPTH - 1)
+
+typedef char TraceDepthPowerOfTwo[(TRACE_DEPTH & TRACE_MASK) == 0 && TRACE_DEPTH <= 128 ? 1 : -1];
+
+
+static TraceSample trace_ring[TRACE_DEPTH];
+
+static uint8_t trace_mode = TRACE_IDLE;
+static uint8_t trace_head;				/* next slot written */
+static uint8_t trace_filled;			/* valid samples, up to TRACE_DEPTH */
+static uint8_t trace_pre;				/* pre-trigger samples asked for */
+static uint8_t trace_kept;				/* pre-trigger samples in this capture */
+static uint8_t trace_post;				/* samples still to record */
+static uint8_t trace_reason;
+static uint8_t trace_capture;			/* capture number */
+static uint8_t trace_next;				/* dump: 0 header, n sample n - 1 */
+
+
+void trace_arm(uint8_t pretrigger)
+{
+	if (pretrigger > TRACE_DEPTH - 1)
+		pretrigger = TRACE_DEPTH - 1;
+
+	trace_pre    = pretrigger;
+	trace_head   = 0;
+	trace_filled = 0;
+	trace_mode   = TRACE_ARMED;
+}
+
+void trace_record(const TraceSample &sample)
+{
+	if (trace_mode != TRACE_ARMED && trace_mode != TRACE_TRIGGERED)
+		return;
+
+	trace_ring[trace_head] = sample;
+	trace_head = (trace_head + 1) & TRACE_MASK;
+	if (trace_filled < TRACE_DEPTH)
+		++trace_filled;
+
+	if (trace_mode == TRACE_TRIGGERED && !--trace_post)
+	{
+		trace_next = 0;
+		trace_mode = TRACE_READY;
+	}
+}
+
+uint8_t trace_trigger(uint8_t reason)
+{
+	if (trace_mode != TRACE_ARMED)
+		return 0;
+
+	/* fewer if it was armed only just before */
+	trace_kept   = trace_filled < trace_pre ? trace_filled : trace_pre;
+	trace_post   = TRACE_DEPTH - trace_kept;
+	trace_reason = reason;
+	trace_mode   = TRACE_TRIGGERED;
+	return 1;
+}
+
+uint8_t trace_state(void)
+{
+	return trace_mode;
+}
+
+
+uint8_t trace_dump_step(void)
+{
+	if (trace_mode != TRACE_READY && trace_mode != TRACE_DUMPING)
+		return 0;
+	trace_mode = TRACE_DUMPING;
+
+	/* the capture is the last TRACE_DEPTH samples written */
+	uint8_t start = trace_head;
+
+	for (;;)
+	{
+		uint8_t frame[TELEMETRY_TRACE_FRAME_SIZE];
+		uint8_t len;
+
+		if (trace_next > TRACE_DEPTH)
+		{
+			++trace_capture;
+			trace_arm(trace_pre);
+			return 1;
+		}
+		if (trace_next == 0)
+		{
+			const TraceSample &first = trace_ring[(start + trace_kept) & TRACE_MASK];
+			len = telemetry_encode_trace_head(trace_reason, trace_capture, first.timestamp,
+											  TRACE_DEPTH, trace_kept, frame);
+		}
+		else
+		{
+			uint8_t index = trace_next - 1;
+			len = telemetry_encode_trace(trace_ring[(start + index) & TRACE_MASK], index,
+										 index == trace_kept, frame);
+		}
+
+		/* whole frames only; the rest goes on the next step. Waiting for
+		   room is not a lost frame, so it is not left to uart0_try_putbuf() */
+		if (uart0_tx_free() < len)
+			return 1;
+		uart0_try_putbuf(frame, len);
+		++trace_next;
+	}
+}
@@ -0,0 +1,74 @@
+/*
+ * trace.h
+ *
+ * Created: 10/17/2026 11:20:36 PM
+ *  Author: Bibek Shrestha
+ *
+ * Triggered capture of the flywheel motors around a throw. The telemetry
+ * task sends one sample per 10 ms and drops records when the line is
+ * busy, which hides the RPM dip and recovery when a disc leaves. This
+ * ring takes one TraceSample per control period instead, in RAM, and the
+ * link only has to carry it afterwards.
+ *
+ * trace_arm() starts recording continuously; the last `pretrigger`
+ * samples are kept until trace_trigger() (a ThrowMotor.Position change
+ * or a command), then it records the rest of the ring and freezes.
+ * trace_dump_step() then sends the capture as binary frames (telemetry.h)
+ * as fast as the TX ring takes them, and re-arms once it is all out.
+ *
+ * Recording and dumping both run from tasks in the main loop, never from
+ * an ISR. The ring takes TRACE_DEPTH * 15 bytes of RAM.
+ */
+
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdint.h>
+
+#ifndef TRACE_DEPTH
+#define TRACE_DEPTH			128			/* samples, power of two up to 128 */
+#endif
+#ifndef TRACE_PRETRIGGER
+#define TRACE_PRETRIGGER	32			/* samples kept from before the trigger */
+#endif
+
+/* trigger reasons, sent in the capture header */
+#define TRACE_TRIGGER_HOME		1		/* ThrowMotor reached HOMEPOSITION */
+#define TRACE_TRIGGER_UP		2		/* ThrowMotor reached UPPOSITION */
+#define TRACE_TRIGGER_COMMAND	3		/* 'c' on uart3 */
+
+enum TraceState
+{
+	TRACE_IDLE,
+	TRACE_ARMED,						/* recording, waiting for the trigger */
+	TRACE_TRIGGERED,					/* recording the post-trigger part */
+	TRACE_READY,						/* frozen, waiting to be sent */
+	TRACE_DUMPING
+};
+
+struct TraceSample
+{
+	uint16_t timestamp;					/* scheduler ticks */
+	uint8_t  position;
+	int16_t  backRPM, backSetpoint, backOcr;
+	int16_t  frontRPM, frontSetpoint, frontOcr;
+};
+
+/* pretrigger is capped at TRACE_DEPTH - 1 */
+void trace_arm(uint8_t pretrigger);
+void trace_record(const TraceSample &sample);
+
+/* returns 1 if it started a capture, 0 if not armed */
+uint8_t trace_trigger(uint8_t reason);
+
+uint8_t trace_state(void);
+
+/*
+ * Queues as many capture frames as the uart0 TX ring has room for.
+ * Returns 1 while a capture is being sent (the caller skips its own
+ * telemetry then), 0 when there is nothing to send.
+ */
+uint8_t trace_dump_step(void);
+
+#endif /* TRACE_H_ */
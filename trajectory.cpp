@@ -0,0 +1,72 @@
+/*
+ * trajectory.cpp
+ *
+ * Created: 10/18/2026 3:05:12 AM
+ *  Author: Bibek Shrestha
+ */
+
+
+#include "trajectory.h"
+
+
+void traj_init(Trajectory &t, uint16_t rate, uint16_t accel, uint8_t tickMs)
+{
+	/* RPM/s^2 * tick^2 * 4096 / 10^6 and RPM/s * tick * 4096 / 1000 */
+	uint32_t a = (uint32_t)accel * tickMs * tickMs * 64 / 15625;
+	uint32_t v = (uint32_t)rate * tickMs * 512 / 125;
+
+	if (a == 0)
+		a = 1;
+	uint32_t n = v / a;
+	if (n == 0)
+		n = 1;
+	if (n > TRAJ_MAX_STEPS)
+		n = TRAJ_MAX_STEPS;
+
+	t.accel = a;
+	t.maxSteps = (int16_t)n;
+	t.steps = 0;
+}
+
+void traj_reset(Trajectory &t, int16_t value)
+{
+	t.position = (int32_t)value * (1L << TRAJ_Q);		/* value may be negative */
+	t.steps = 0;
+}
+
+/* distance covered braking from n steps to rest: n + (n-1) + ... + 1 */
+static inline uint32_t traj_brake(const Trajectory &t, uint16_t n)
+{
+	return t.accel * (((uint32_t)n * (n + 1)) >> 1);
+}
+
+int16_t traj_step(Trajectory &t, int16_t target)
+{
+	int32_t goal = (int32_t)target * (1L << TRAJ_Q);
+	int32_t error = goal - t.position;
+
+	if (error == 0 && t.steps == 0)
+		return target;
+
+	int8_t direction = (error >= 0) ? 1 : -1;
+	uint32_t distance = (error >= 0) ? (uint32_t)error : (uint32_t)(0 - error);
+	int16_t toward = t.steps * direction;
+
+	if (toward <= 0)
+		t.steps += direction;			/* at rest or heading away: turn round */
+	else if (toward < t.maxSteps && distance >= traj_brake(t, toward + 1))
+		t.steps += direction;			/* room to go one step faster */
+	else if (distance < traj_brake(t, toward))
+		t.steps -= direction;			/* brake */
+
+	int32_t move = (int32_t)t.steps * (int32_t)t.accel;
+	if ((t.steps > 0) == (direction > 0) && (uint32_t)(move * direction) >= distance)
+	{
+		/* the last step lands on the goal */
+		t.position = goal;
+		t.steps = 0;
+		return target;
+	}
+	t.position += move;
+	return (int16_t)((t.position + (1L << (TRAJ_Q - 1))) >> TRAJ_Q);
+}
@@ -0,0 +1,51 @@
+/*
+ * trajectory.h
+ *
+ * Created: 10/18/2026 3:05:12 AM
+ *  Author: Bibek Shrestha
+ *
+ * Setpoint trajectory for one flywheel. Instead of stepping, the
+ * reference the PID works on moves towards the commanded setpoint with
+ * its rate of change (the motor's acceleration, RPM/s) and the change of
+ * that rate (the motor's jerk, RPM/s^2) both limited, so spin-ups and
+ * spin-downs are S-shaped and the output stays clear of MAX_OUTPUT. It
+ * brakes just in time to arrive without overshoot; a new setpoint on
+ * the way is followed from the current rate.
+ *
+ * Position is Q12 RPM. The rate is kept as a whole number of
+ * acceleration steps, so the braking distance is one multiply and a
+ * tick is a handful of 32 bit adds. One traj_step() per control tick.
+ */
+
+
+#ifndef TRAJECTORY_H_
+#define TRAJECTORY_H_
+
+#include <stdint.h>
+
+#define TRAJ_Q				12
+#define TRAJ_MAX_STEPS		1000		/* ticks to reach the rate, at most */
+
+struct Trajectory
+{
+	int32_t  position;					/* Q12 RPM */
+	int16_t  steps;						/* rate, in steps of accel; signed */
+	int16_t  maxSteps;
+	uint32_t accel;						/* Q12 RPM per tick per tick */
+};
+
+/* rate in RPM/s, accel in RPM/s^2, tickMs up to 10 */
+void traj_init(Trajectory &t, uint16_t rate, uint16_t accel, uint8_t tickMs);
+
+/* jumps to value, at rest */
+void traj_reset(Trajectory &t, int16_t value);
+
+/* advances one tick towards target, returns the new reference */
+int16_t traj_step(Trajectory &t, int16_t target);
+
+static inline bool traj_moving(const Trajectory &t)
+{
+	return t.steps != 0;
+}
+
+#endif /* TRAJECTORY_H_ */
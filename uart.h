@@ -130,9 +130,36 @@ Date        Description
 #define UART_TX_BUFFER_SIZE 32
 #endif
 
+/** Per port buffer sizes, power of 2 up to 256; default to the sizes above */
+#ifndef UART0_RX_BUFFER_SIZE
+#define UART0_RX_BUFFER_SIZE UART_RX_BUFFER_SIZE
+#endif
+#ifndef UART0_TX_BUFFER_SIZE
+#define UART0_TX_BUFFER_SIZE 64		/* telemetry: a whole ASCII line, three binary records */
+#endif
+#ifndef UART1_RX_BUFFER_SIZE
+#define UART1_RX_BUFFER_SIZE UART_RX_BUFFER_SIZE
+#endif
+#ifndef UART1_TX_BUFFER_SIZE
+#define UART1_TX_BUFFER_SIZE UART_TX_BUFFER_SIZE
+#endif
+#ifndef UART2_RX_BUFFER_SIZE
+#define UART2_RX_BUFFER_SIZE UART_RX_BUFFER_SIZE
+#endif
+#ifndef UART2_TX_BUFFER_SIZE
+#define UART2_TX_BUFFER_SIZE UART_TX_BUFFER_SIZE
+#endif
+#ifndef UART3_RX_BUFFER_SIZE
+#define UART3_RX_BUFFER_SIZE UART_RX_BUFFER_SIZE
+#endif
+#ifndef UART3_TX_BUFFER_SIZE
+#define UART3_TX_BUFFER_SIZE 16		/* command link: one frame answer (command.h) */
+#endif
+
 /* test if the size of the circular buffers fits into SRAM */
-#if ( (UART_RX_BUFFER_SIZE+UART_TX_BUFFER_SIZE) >= (RAMEND-0x60 ) )
-#error "size of UART_RX_BUFFER_SIZE + UART_TX_BUFFER_SIZE larger than size of SRAM"
+#if ( (UART0_RX_BUFFER_SIZE+UART0_TX_BUFFER_SIZE+UART1_RX_BUFFER_SIZE+UART1_TX_BUFFER_SIZE \
+	 +UART2_RX_BUFFER_SIZE+UART2_TX_BUFFER_SIZE+UART3_RX_BUFFER_SIZE+UART3_TX_BUFFER_SIZE) >= (RAMEND-0x60 ) )
+#error "size of the UART buffers larger than size of SRAM"
 #endif
 
 /* 
@@ -209,7 +236,7 @@ extern void uart0_putc(unsigned char data);
 /**
  * @brief    Put integer from program memory to ringbuffer for transmitting via UART.
  *
- * The integer is converted to ascii string via itoa()
+ * The integer is converted to decimal digits without division (format.h)
  * The string is buffered by the uart library in a circular buffer
  * and one character at a time is transmitted to the UART using interrupts.
  * Blocks if it can not write the whole string into the circular buffer.
@@ -222,6 +249,58 @@ extern void uart0_putc(unsigned char data);
 extern void uart0_puts(const char *s );
 
 
+/**
+ * @brief    Put a block of bytes to ringbuffer for transmitting via UART
+ *
+ * The block is copied with a single update of the ringbuffer head, so the
+ * interrupt never sends a partial block. Blocks until the whole block fits.
+ *
+ * @param    buf  bytes to be transmitted
+ * @param    len  number of bytes, at most UART0_TX_BUFFER_SIZE-1
+ * @return   none
+ */
+extern void uart0_putbuf(const unsigned char *buf, unsigned char len);
+
+
+/**
+ * @brief    Put a whole block to the ringbuffer or nothing, never waits
+ *
+ * A block that does not fit is discarded and counted in uart0_tx_dropped().
+ *
+ * @param    buf  bytes to be transmitted
+ * @param    len  number of bytes, at most UART0_TX_BUFFER_SIZE-1
+ * @return   1 when queued, 0 when dropped
+ */
+extern unsigned char uart0_try_putbuf(const unsigned char *buf, unsigned char len);
+
+
+/**
+ * @brief    Put as much of a block as fits into the ringbuffer, never waits
+ *
+ * A block that was cut short is counted in uart0_tx_dropped().
+ *
+ * @param    buf  bytes to be transmitted
+ * @param    len  number of bytes
+ * @return   number of bytes queued
+ */
+extern unsigned char uart0_try_write(const unsigned char *buf, unsigned char len);
+
+
+/**
+ * @brief    Free space in the transmit ringbuffer
+ * @return   bytes that can be queued without waiting
+ */
+extern unsigned char uart0_tx_free(void);
+
+
+/**
+ * @brief    Blocks uart0_try_putbuf()/uart0_try_write() could not send whole
+ * @return   count since start or the last uart0_clear_tx_dropped(), saturating
+ */
+extern unsigned int uart0_tx_dropped(void);
+extern void uart0_clear_tx_dropped(void);
+
+
 /**
  * @brief    Put string from program memory to ringbuffer for transmitting via UART.
  *
@@ -310,14 +389,36 @@ extern void uart3_puts(const char *s );
 extern void uart3_puts_p(const char *s );
 /** @brief  Macro to automatically put a string constant into program memory */
 #define uart3_puts_P(__s)       uart3_puts_p(PSTR(__s))
+/** @brief  Put a whole block or nothing to USART3, never waits @see uart0_try_putbuf */
+extern unsigned char uart3_try_putbuf(const unsigned char *buf, unsigned char len);
+/** @brief  Put as much of a block as fits to USART3, never waits @see uart0_try_write */
+extern unsigned char uart3_try_write(const unsigned char *buf, unsigned char len);
+/** @brief  Free space in the USART3 transmit ringbuffer */
+extern unsigned char uart3_tx_free(void);
+/** @brief  Blocks USART3 could not send whole @see uart0_tx_dropped */
+extern unsigned int uart3_tx_dropped(void);
+extern void uart3_clear_tx_dropped(void);
 /** @brief   Return number of bytes waiting in the receive buffer */
 extern int uart3_available(void);
 /** @brief   Flush bytes waiting in receive buffer */
 extern void uart3_flush(void);
+/** @brief   Act on received bytes in the USART3 receive interrupt; nonzero from filter drops the byte @see UartPort::rx_isr_filtered */
+extern void uart3_set_rx_filter(unsigned char (*filter)(unsigned char));
 
 /**@}*/
 
 
+/*
+ * The ports themselves, for code that wants the calls inlined; see
+ * uart_port.h. The uartN_* functions above wrap these.
+ */
+#include "uart_port.h"
+
+typedef UartPort<0, UART0_RX_BUFFER_SIZE, UART0_TX_BUFFER_SIZE> Uart0;
+typedef UartPort<1, UART1_RX_BUFFER_SIZE, UART1_TX_BUFFER_SIZE> Uart1;
+typedef UartPort<2, UART2_RX_BUFFER_SIZE, UART2_TX_BUFFER_SIZE> Uart2;
+typedef UartPort<3, UART3_RX_BUFFER_SIZE, UART3_TX_BUFFER_SIZE> Uart3;
+
 
 #endif // UART_H 
 
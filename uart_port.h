@@ -0,0 +1,362 @@
+/*
+ * uart_port.h
+ *
+ * Created: 10/17/2026 9:14:37 PM
+ *  Author: Bibek Shrestha
+ *
+ * Interrupt driven USART with receive/transmit ring buffers, one class
+ * per port: UartPort<N, RxSize, TxSize>. The registers of port N are
+ * bound at compile time through UartRegisters<N>, so every access is a
+ * fixed address the compiler folds into a single LDS/STS, and every port
+ * has its own buffer sizes. Only the members a program calls are
+ * instantiated.
+ *
+ * Ring buffer scheme of Peter Fleury's uart library (Atmel AVR306): head
+ * and tail index the last written/read slot, one slot stays empty, sizes
+ * are powers of 2 up to 256 so indices wrap with a mask.
+ *
+ * put()/putbuf()/puts() wait for room in the TX ring. try_putbuf() and
+ * try_write() never wait: the first queues a whole record or nothing,
+ * the second as much as fits; either way a record that did not go out
+ * whole is counted in tx_dropped(). Use them from anything that runs in
+ * the control loop.
+ *
+ * The ISRs stay with the application, which calls rx_isr()/udre_isr():
+ *
+ *   ISR(USART0_RX_vect)   { Uart0::rx_isr(); }
+ *   ISR(USART0_UDRE_vect) { Uart0::udre_isr(); }
+ *
+ * A port whose RX interrupt calls rx_isr_filtered() instead hands every
+ * byte received without error to the function given to set_rx_filter()
+ * first, still in the interrupt; bytes it returns nonzero for were acted
+ * on there and are not queued. That is for commands that cannot wait
+ * for the main loop to read them.
+ */ 
+
+
+#ifndef UART_PORT_H_
+#define UART_PORT_H_
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "format.h"
+
+/* high byte error return codes of get(), as in uart.h */
+#ifndef UART_NO_DATA
+#define UART_FRAME_ERROR      0x0800
+#define UART_OVERRUN_ERROR    0x0400
+#define UART_BUFFER_OVERFLOW  0x0200
+#define UART_NO_DATA          0x0100
+#endif
+
+
+/*
+ * Register binding. The control/status bits sit in the same positions on
+ * every USART of the ATmega640/1280/2560, so the port 0 bit names are
+ * used for all of them.
+ */
+template <uint8_t N> struct UartRegisters;
+
+#ifdef UCSR0A
+template <> struct UartRegisters<0>
+{
+	static volatile uint8_t &ucsra(void) { return UCSR0A; }
+	static volatile uint8_t &ucsrb(void) { return UCSR0B; }
+	static volatile uint8_t &ucsrc(void) { return UCSR0C; }
+	static volatile uint8_t &ubrrl(void) { return UBRR0L; }
+	static volatile uint8_t &ubrrh(void) { return UBRR0H; }
+	static volatile uint8_t &udr(void)   { return UDR0; }
+};
+#endif
+
+#ifdef UCSR1A
+template <> struct UartRegisters<1>
+{
+	static volatile uint8_t &ucsra(void) { return UCSR1A; }
+	static volatile uint8_t &ucsrb(void) { return UCSR1B; }
+	static volatile uint8_t &ucsrc(void) { return UCSR1C; }
+	static volatile uint8_t &ubrrl(void) { return UBRR1L; }
+	static volatile uint8_t &ubrrh(void) { return UBRR1H; }
+	static volatile uint8_t &udr(void)   { return UDR1; }
+};
+#endif
+
+#ifdef UCSR2A
+template <> struct UartRegisters<2>
+{
+	static volatile uint8_t &ucsra(void) { return UCSR2A; }
+	static volatile uint8_t &ucsrb(void) { return UCSR2B; }
+	static volatile uint8_t &ucsrc(void) { return UCSR2C; }
+	static volatile uint8_t &ubrrl(void) { return UBRR2L; }
+	static volatile uint8_t &ubrrh(void) { return UBRR2H; }
+	static volatile uint8_t &udr(void)   { return UDR2; }
+};
+#endif
+
+#ifdef UCSR3A
+template <> struct UartRegisters<3>
+{
+	static volatile uint8_t &ucsra(void) { return UCSR3A; }
+	static volatile uint8_t &ucsrb(void) { return UCSR3B; }
+	static volatile uint8_t &ucsrc(void) { return UCSR3C; }
+	static volatile uint8_t &ubrrl(void) { return UBRR3L; }
+	static volatile uint8_t &ubrrh(void) { return UBRR3H; }
+	static volatile uint8_t &udr(void)   { return UDR3; }
+};
+#endif
+
+
+template <uint8_t N, uint16_t RxSize, uint16_t TxSize>
+class UartPort
+{
+	typedef UartRegisters<N> Reg;
+
+	/* buffer sizes must be powers of 2 from 2 to 256 (C++98, no static_assert) */
+	typedef char RxSizeIsPowerOf2[(RxSize >= 2 && RxSize <= 256 && !(RxSize & (RxSize - 1))) ? 1 : -1];
+	typedef char TxSizeIsPowerOf2[(TxSize >= 2 && TxSize <= 256 && !(TxSize & (TxSize - 1))) ? 1 : -1];
+
+	static const uint8_t RxMask = RxSize - 1;
+	static const uint8_t TxMask = TxSize - 1;
+
+	static volatile uint8_t rxBuf[RxSize];
+	static volatile uint8_t txBuf[TxSize];
+	static volatile uint8_t rxHead, rxTail;
+	static volatile uint8_t txHead, txTail;
+	static volatile uint8_t lastRxError;
+	static uint16_t txDropped;			/* written by the main loop only */
+	static uint8_t (*rxFilter)(uint8_t data);
+
+	static void drop(void)
+	{
+		if (txDropped != 0xFFFF)
+			++txDropped;
+	}
+
+	/* copy to the ring behind head and publish with one head update */
+	static void queue(const uint8_t *buf, uint8_t len)
+	{
+		uint8_t head = txHead;
+
+		while (len--)
+		{
+			head = (head + 1) & TxMask;
+			txBuf[head] = *buf++;
+		}
+		txHead = head;
+		Reg::ucsrb() |= _BV(UDRIE0);
+	}
+
+	static void store(uint8_t data, uint8_t error)
+	{
+		uint8_t head = (rxHead + 1) & RxMask;
+
+		if (head == rxTail)
+		{
+			error = UART_BUFFER_OVERFLOW >> 8;
+		}
+		else
+		{
+			rxBuf[head] = data;
+			rxHead = head;
+		}
+		lastRxError = error;
+	}
+
+	public:
+	/* baudrate from UART_BAUD_SELECT() or UART_BAUD_SELECT_DOUBLE_SPEED() */
+	static void init(unsigned int baudrate)
+	{
+		rxHead = rxTail = 0;
+		txHead = txTail = 0;
+
+		if (baudrate & 0x8000)
+		{
+			Reg::ucsra() = _BV(U2X0);
+			baudrate &= ~0x8000;
+		}
+		Reg::ubrrh() = (uint8_t)(baudrate >> 8);
+		Reg::ubrrl() = (uint8_t)baudrate;
+
+		/* receiver, transmitter and receive complete interrupt; 8N1 */
+		Reg::ucsrb() = _BV(RXCIE0) | _BV(RXEN0) | _BV(TXEN0);
+		Reg::ucsrc() = _BV(UCSZ00) | _BV(UCSZ01);
+	}
+
+	/* received byte in the low byte, last receive error or UART_NO_DATA in the high byte */
+	static unsigned int get(void)
+	{
+		uint8_t tail = rxTail;
+
+		if (rxHead == tail)
+			return UART_NO_DATA;
+
+		tail = (tail + 1) & RxMask;
+		rxTail = tail;
+		return (lastRxError << 8) + rxBuf[tail];
+	}
+
+	/* blocks while the ring is full */
+	static void put(uint8_t data)
+	{
+		uint8_t head = (txHead + 1) & TxMask;
+
+		while (head == txTail)
+			;
+
+		txBuf[head] = data;
+		txHead = head;
+		Reg::ucsrb() |= _BV(UDRIE0);
+	}
+
+	/* whole block with one head update; blocks until it fits, len < TxSize */
+	static void putbuf(const uint8_t *buf, uint8_t len)
+	{
+		while (tx_free() < len)
+			;
+		queue(buf, len);
+	}
+
+	/* free slots in the TX ring; only grows while the caller looks */
+	static uint8_t tx_free(void)
+	{
+		return (txTail - txHead - 1) & TxMask;
+	}
+
+	/* whole block or nothing; returns 0 and counts a drop when it does not fit */
+	static uint8_t try_putbuf(const uint8_t *buf, uint8_t len)
+	{
+		if (tx_free() < len)
+		{
+			drop();
+			return 0;
+		}
+		queue(buf, len);
+		return 1;
+	}
+
+	/* as much of the block as fits; returns the bytes taken, a short write counts as a drop */
+	static uint8_t try_write(const uint8_t *buf, uint8_t len)
+	{
+		uint8_t room = tx_free();
+
+		if (room < len)
+		{
+			drop();
+			len = room;
+		}
+		queue(buf, len);
+		return len;
+	}
+
+	/* records try_putbuf()/try_write() could not send whole, saturating */
+	static uint16_t tx_dropped(void)
+	{
+		return txDropped;
+	}
+
+	static void clear_tx_dropped(void)
+	{
+		txDropped = 0;
+	}
+
+	static void puts(const char *s)
+	{
+		while (*s)
+			put(*s++);
+	}
+
+	static void puts_p(const char *progmem_s)
+	{
+		char c;
+
+		while ((c = pgm_read_byte(progmem_s++)))
+			put(c);
+	}
+
+	/* decimal, straight into the ring (format.h) */
+	static void putint(int value)
+	{
+		UartPort port;
+		fmt_i16(port, value);
+	}
+
+	static uint8_t available(void)
+	{
+		return (rxHead - rxTail) & RxMask;
+	}
+
+	/* drops what is waiting; moves the tail, which only the reader owns */
+	static void flush(void)
+	{
+		rxTail = rxHead;
+	}
+
+	/* USARTn_RX_vect */
+	static void rx_isr(void)
+	{
+		uint8_t usr = Reg::ucsra();
+		uint8_t data = Reg::udr();
+
+		store(data, usr & (_BV(FE0) | _BV(DOR0)));
+	}
+
+	/* set before the receive interrupt is on; 0 for none */
+	static void set_rx_filter(uint8_t (*filter)(uint8_t data))
+	{
+		rxFilter = filter;
+	}
+
+	/* USARTn_RX_vect of a port with a filter */
+	static void rx_isr_filtered(void)
+	{
+		uint8_t usr = Reg::ucsra();
+		uint8_t data = Reg::udr();
+		uint8_t error = usr & (_BV(FE0) | _BV(DOR0));
+
+		if (!error && rxFilter && rxFilter(data))
+			return;
+		store(data, error);
+	}
+
+	/* USARTn_UDRE_vect */
+	static void udre_isr(void)
+	{
+		uint8_t tail = txTail;
+
+		if (txHead != tail)
+		{
+			tail = (tail + 1) & TxMask;
+			txTail = tail;
+			Reg::udr() = txBuf[tail];
+		}
+		else
+		{
+			/* ring empty */
+			Reg::ucsrb() &= ~_BV(UDRIE0);
+		}
+	}
+};
+
+template <uint8_t N, uint16_t RxSize, uint16_t TxSize>
+volatile uint8_t UartPort<N, RxSize, TxSize>::rxBuf[RxSize];
+template <uint8_t N, uint16_t RxSize, uint16_t TxSize>
+volatile uint8_t UartPort<N, RxSize, TxSize>::txBuf[TxSize];
+template <uint8_t N, uint16_t RxSize, uint16_t TxSize>
+volatile uint8_t UartPort<N, RxSize, TxSize>::rxHead;
+template <uint8_t N, uint16_t RxSize, uint16_t TxSize>
+volatile uint8_t UartPort<N, RxSize, TxSize>::rxTail;
+template <uint8_t N, uint16_t RxSize, uint16_t TxSize>
+volatile uint8_t UartPort<N, RxSize, TxSize>::txHead;
+template <uint8_t N, uint16_t RxSize, uint16_t TxSize>
+volatile uint8_t UartPort<N, RxSize, TxSize>::txTail;
+template <uint8_t N, uint16_t RxSize, uint16_t TxSize>
+volatile uint8_t UartPort<N, RxSize, TxSize>::lastRxError;
+template <uint8_t N, uint16_t RxSize, uint16_t TxSize>
+uint16_t UartPort<N, RxSize, TxSize>::txDropped;
+template <uint8_t N, uint16_t RxSize, uint16_t TxSize>
+uint8_t (*UartPort<N, RxSize, TxSize>::rxFilter)(uint8_t data);
+
+#endif /* UART_PORT_H_ */